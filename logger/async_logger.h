@@ -0,0 +1,97 @@
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include "iface.h"
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Асинхронная обёртка над синком: log() только кладёт запись в очередь,
+// фоновый поток забирает очередь целиком и отдаёт её синку одним
+// log_batch(). При переполнении очереди записи отбрасываются, а не
+// блокируют вызывающий поток.
+//
+// В метриках обёртки - глубина очереди и её максимум; в метриках целевого
+// синка - число записей и средняя задержка записи на пачку. В GLogger::stats()
+// попадают обе.
+class AsyncLogger : public ILogger {
+    std::shared_ptr<ILogger> target;
+    size_t capacity;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<LogRecord> queue;
+    bool stop = false;
+    std::thread worker;
+
+    void run() {
+        std::vector<LogRecord> batch;
+        std::unique_lock<std::mutex> lock(this->mtx);
+        for (;;) {
+            this->cv.wait(lock, [this] { return this->stop || !this->queue.empty(); });
+            if (this->queue.empty() && this->stop) return;
+
+            batch.swap(this->queue);
+            this->sink_metrics.queue_size(0);
+            lock.unlock();
+
+            auto start = std::chrono::steady_clock::now();
+            this->target->log_batch(batch.data(), batch.size());
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+            metrics::SinkMetrics& m = this->target->metrics();
+            m.messages.add(batch.size());
+            m.latency.record(static_cast<uint64_t>(elapsed) / batch.size(), batch.size());
+            batch.clear();
+
+            lock.lock();
+        }
+    }
+
+public:
+    explicit AsyncLogger(std::shared_ptr<ILogger> target, size_t capacity = 64 * 1024)
+        : target(std::move(target)), capacity(capacity) {
+        this->queue.reserve(this->capacity);
+        this->worker = std::thread(&AsyncLogger::run, this);
+    }
+
+    // Дописывает всё, что осталось в очереди
+    ~AsyncLogger() {
+        {
+            std::lock_guard<std::mutex> lock(this->mtx);
+            this->stop = true;
+        }
+        this->cv.notify_one();
+        this->worker.join();
+    }
+
+    void log(LogLevel level, const std::string& message) override {
+        LogRecord record{level, std::chrono::system_clock::now(), message};
+        {
+            std::lock_guard<std::mutex> lock(this->mtx);
+            if (this->queue.size() >= this->capacity) {
+                this->sink_metrics.dropped.add();
+                return;
+            }
+            this->queue.push_back(std::move(record));
+            this->sink_metrics.queue_size(this->queue.size());
+        }
+        this->cv.notify_one();
+    }
+
+    std::string name() const override { return "async(" + this->target->name() + ")"; }
+
+    // Своя очередь и следом целевой синк: его байты, потери и задержка записи
+    void collect_stats(std::vector<metrics::SinkStats>& out) const override {
+        ILogger::collect_stats(out);
+        this->target->collect_stats(out);
+    }
+
+    size_t dropped() const { return this->sink_metrics.dropped.get(); }
+};
+
+#endif // ASYNC_LOGGER_H
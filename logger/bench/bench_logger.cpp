@@ -0,0 +1,242 @@
+// Бенчмарк пропускной способности и задержки GLogger.
+//
+// Для каждой комбинации синк x диспетчеризация x режим нагрузки запускает
+// N потоков, которые пишут через GLogger::info, и печатает одну JSON-строку
+// на прогон (JSON Lines) - удобно складывать в файл и сравнивать между версиями.
+//
+//   closed - каждый поток пишет следующее сообщение сразу после предыдущего;
+//   open   - сообщения идут по расписанию с частотой --rate на поток,
+//            задержка считается от запланированного момента (без
+//            coordinated omission); последние 200 мкс до него поток
+//            крутится, чтобы опоздание таймера не считалось задержкой.
+//
+// Диспетчеризация: sync - синк вызывается прямо в потоке, async - через AsyncLogger,
+// perthread - буферы по потокам со сборщиком (GLogger::start_collector).
+//
+// Использование:
+//   bench_logger [--threads N] [--messages M] [--rate R]
+//                [--sinks null,console,file,syslog] [--dispatch sync,async,perthread]
+//                [--loops closed,open] [--file bench.log]
+
+#include "../iface.h"
+#include "../loggers.h"
+#include "../async_logger.h"
+#include "../metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Синк, который ничего не делает: стоимость самого GLogger
+class NullLogger : public ILogger {
+public:
+    std::string name() const override { return "null"; }
+    void log(LogLevel, const std::string&) override {}
+};
+
+struct Config {
+    int threads = 4;
+    long messages = 100000;        // на поток
+    double rate = 50000;           // сообщений в секунду на поток (open)
+    std::vector<std::string> sinks = {"null", "console", "file", "syslog"};
+    std::vector<std::string> dispatch = {"sync", "async", "perthread"};
+    std::vector<std::string> loops = {"closed", "open"};
+    std::string file = "bench.log";
+};
+
+struct Result {
+    double seconds = 0;        // пока писали производители
+    double drain_seconds = 0;  // дописывание очереди после них (async)
+    uint64_t dropped = 0;
+    metrics::LatencyHistogram latency;
+};
+
+static std::vector<std::string> split(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+static std::shared_ptr<ILogger> make_sink(const std::string& name, const Config& cfg) {
+    if (name == "null")    return std::make_shared<NullLogger>();
+    if (name == "console") return std::make_shared<ConsoleLogger>();
+    if (name == "file")    return std::make_shared<FileLogger>(cfg.file);
+#ifdef __linux__
+    if (name == "syslog")  return std::make_shared<SyslogLogger>();
+#endif
+    return nullptr;
+}
+
+// Сколько до запланированного момента ждать без сна (open)
+constexpr std::chrono::microseconds SPIN{200};
+
+static void producer(int id, const Config& cfg, const std::string& loop,
+                     std::atomic<bool>& go, metrics::LatencyHistogram& latency) {
+    using clock = std::chrono::steady_clock;
+
+    const std::string message = "bench thread " + std::to_string(id) + " payload 0123456789abcdef";
+    const auto period = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / cfg.rate));
+
+    while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+    const auto begin = clock::now();
+    for (long i = 0; i < cfg.messages; ++i) {
+        clock::time_point start;
+        if (loop == "open") {
+            start = begin + period * i;
+            // Таймер просыпается с опозданием в десятки мкс, и оно попало бы
+            // в задержку вызова: спим до start - SPIN, остаток крутимся
+            if (clock::now() < start - SPIN) {
+                std::this_thread::sleep_until(start - SPIN);
+            }
+            while (clock::now() < start) std::this_thread::yield();
+        } else {
+            start = clock::now();
+        }
+
+        GLogger::info(message);
+
+        auto elapsed = clock::now() - start;
+        latency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+}
+
+static void run(const Config& cfg, const std::string& sink_name, const std::string& dispatch,
+                const std::string& loop, Result& result) {
+    std::shared_ptr<ILogger> sink = make_sink(sink_name, cfg);
+    std::shared_ptr<AsyncLogger> async;
+    if (dispatch == "async") {
+        async = std::make_shared<AsyncLogger>(sink);
+        GLogger::add(async);
+    } else {
+        GLogger::add(sink);
+    }
+    if (dispatch == "perthread") GLogger::start_collector();
+
+    // У каждого производителя своя гистограмма: общая мерила бы
+    // конкуренцию за её кеш-линии, а не логгер
+    std::vector<metrics::LatencyHistogram> latency(cfg.threads);
+
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < cfg.threads; ++i) {
+        threads.emplace_back(producer, i, std::cref(cfg), std::cref(loop),
+                             std::ref(go), std::ref(latency[i]));
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) t.join();
+    auto produced = std::chrono::steady_clock::now();
+    for (const auto& h : latency) result.latency.merge(h);
+
+    GLogger::stop_collector();  // ждём, пока сборщик допишет буферы
+    GLogger::clear();
+    if (async) {
+        result.dropped += async->dropped();
+        async.reset();  // ждём, пока очередь допишется
+    }
+    result.dropped += sink->metrics().dropped.get();
+    auto drained = std::chrono::steady_clock::now();
+
+    result.seconds = std::chrono::duration<double>(produced - begin).count();
+    result.drain_seconds = std::chrono::duration<double>(drained - produced).count();
+}
+
+static void report(FILE* out, const Config& cfg, const std::string& sink, const std::string& dispatch,
+                   const std::string& loop, const Result& r) {
+    const double total = static_cast<double>(cfg.messages) * cfg.threads;
+    std::fprintf(out,
+                 "{\"sink\":\"%s\",\"dispatch\":\"%s\",\"loop\":\"%s\",\"threads\":%d,"
+                 "\"messages\":%.0f,\"seconds\":%.6f,\"drain_seconds\":%.6f,"
+                 "\"msgs_per_sec\":%.0f,\"msgs_per_sec_with_drain\":%.0f,\"dropped\":%llu,"
+                 "\"p50_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,\"max_ns\":%llu}\n",
+                 sink.c_str(), dispatch.c_str(), loop.c_str(), cfg.threads,
+                 total, r.seconds, r.drain_seconds,
+                 total / r.seconds, total / (r.seconds + r.drain_seconds),
+                 static_cast<unsigned long long>(r.dropped),
+                 static_cast<unsigned long long>(r.latency.percentile(0.50)),
+                 static_cast<unsigned long long>(r.latency.percentile(0.99)),
+                 static_cast<unsigned long long>(r.latency.percentile(0.999)),
+                 static_cast<unsigned long long>(r.latency.max()));
+    std::fflush(out);
+}
+
+int main(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            std::fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 1;
+        }
+        ++i;
+
+        if (arg == "--threads")       cfg.threads = std::atoi(value);
+        else if (arg == "--messages") cfg.messages = std::atol(value);
+        else if (arg == "--rate")     cfg.rate = std::atof(value);
+        else if (arg == "--sinks")    cfg.sinks = split(value);
+        else if (arg == "--dispatch") cfg.dispatch = split(value);
+        else if (arg == "--loops")    cfg.loops = split(value);
+        else if (arg == "--file")     cfg.file = value;
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+    }
+    if (cfg.threads < 1 || cfg.messages < 1 || cfg.rate <= 0) {
+        std::fprintf(stderr, "Bad --threads, --messages or --rate\n");
+        return 1;
+    }
+    for (const auto& d : cfg.dispatch) {
+        if (d != "sync" && d != "async" && d != "perthread") {
+            std::fprintf(stderr, "Unknown dispatch %s\n", d.c_str());
+            return 1;
+        }
+    }
+    for (const auto& l : cfg.loops) {
+        if (l != "closed" && l != "open") {
+            std::fprintf(stderr, "Unknown loop %s\n", l.c_str());
+            return 1;
+        }
+    }
+
+    // Результаты - в настоящий stdout, ConsoleLogger - в /dev/null
+    FILE* out = fdopen(dup(STDOUT_FILENO), "w");
+    int devnull = ::open("/dev/null", O_WRONLY);
+    dup2(devnull, STDOUT_FILENO);
+    close(devnull);
+
+    for (const auto& sink : cfg.sinks) {
+        if (!make_sink(sink, cfg)) {
+            std::fprintf(stderr, "Unknown sink %s\n", sink.c_str());
+            continue;
+        }
+        for (const auto& dispatch : cfg.dispatch) {
+            for (const auto& loop : cfg.loops) {
+                Result result;
+                run(cfg, sink, dispatch, loop, result);
+                report(out, cfg, sink, dispatch, loop, result);
+            }
+        }
+    }
+
+    std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,335 @@
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include "iface.h"
+#include "rcu.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Отложенное бинарное логирование в стиле NanoLog.
+//
+// Форматная строка регистрируется один раз и получает статический id.
+// В месте вызова в буфер потока пишутся только id, уровень, время и сырые
+// байты аргументов - никакого форматирования текста. Текст восстанавливается
+// потом, утилитой binlog_decode.
+//
+// Формат файла:
+//   "BLOG" u32 version
+//   'F' u32 id u16 len <len байт форматной строки>
+//   'R' u32 id u8 level u64 time_ns u16 len <len байт аргументов>
+// Каждый аргумент: u8 тип ('i' int64, 'u' uint64, 'd' double,
+// 's' u16 len + байты). Числа пишутся в порядке байт хоста.
+// Плейсхолдер в форматной строке - "{}".
+
+namespace binlog {
+
+constexpr char     MAGIC[4] = {'B', 'L', 'O', 'G'};
+constexpr uint32_t VERSION  = 1;
+
+enum : uint8_t {
+    TAG_FORMAT = 'F',
+    TAG_RECORD = 'R'
+};
+
+enum : uint8_t {
+    ARG_INT    = 'i',
+    ARG_UINT   = 'u',
+    ARG_DOUBLE = 'd',
+    ARG_STRING = 's'
+};
+
+// Буфер потока сбрасывается в файл при таком размере
+constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+// Реестр форматных строк. id - индекс в реестре.
+class Formats {
+    static inline std::mutex mtx;
+    static inline std::vector<const char*> formats;
+
+public:
+    static uint32_t add(const char* fmt) {
+        std::lock_guard<std::mutex> lock(mtx);
+        formats.push_back(fmt);
+        return static_cast<uint32_t>(formats.size() - 1);
+    }
+
+    static size_t size() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return formats.size();
+    }
+
+    static const char* get(uint32_t id) {
+        std::lock_guard<std::mutex> lock(mtx);
+        return id < formats.size() ? formats[id] : nullptr;
+    }
+};
+
+template <typename T>
+inline void put(std::vector<char>& buf, T value) {
+    static_assert(std::is_trivially_copyable<T>::value, "raw bytes only");
+    const char* p = reinterpret_cast<const char*>(&value);
+    buf.insert(buf.end(), p, p + sizeof(T));
+}
+
+inline void put_string(std::vector<char>& buf, const char* s, size_t len) {
+    if (len > UINT16_MAX) len = UINT16_MAX;
+    put<uint8_t>(buf, ARG_STRING);
+    put<uint16_t>(buf, static_cast<uint16_t>(len));
+    buf.insert(buf.end(), s, s + len);
+}
+
+inline void encode(std::vector<char>& buf, const char* s)        { put_string(buf, s, std::strlen(s)); }
+inline void encode(std::vector<char>& buf, char* s)              { put_string(buf, s, std::strlen(s)); }
+inline void encode(std::vector<char>& buf, const std::string& s) { put_string(buf, s.data(), s.size()); }
+
+template <typename T>
+inline void encode(std::vector<char>& buf, T value) {
+    static_assert(std::is_arithmetic<T>::value, "binlog: unsupported argument type");
+    if constexpr (std::is_floating_point<T>::value) {
+        put<uint8_t>(buf, ARG_DOUBLE);
+        put<double>(buf, static_cast<double>(value));
+    } else if constexpr (std::is_signed<T>::value) {
+        put<uint8_t>(buf, ARG_INT);
+        put<int64_t>(buf, static_cast<int64_t>(value));
+    } else {
+        put<uint8_t>(buf, ARG_UINT);
+        put<uint64_t>(buf, static_cast<uint64_t>(value));
+    }
+}
+
+class BinaryFileLogger;
+
+// Активный бинарный синк, в который сбрасываются буферы потоков.
+// Сброс читает его под rcu::Guard, поэтому синк можно убрать из GLogger
+// и разрушить, пока другие потоки пишут.
+inline std::atomic<BinaryFileLogger*> active_sink{nullptr};
+
+// Буфер потока. Спин-блокировку берёт только сам поток на время записи;
+// чужой поток - лишь при разрушении синка, чтобы дописать его буфер.
+struct ThreadBuffer {
+    std::vector<char> data;
+    std::atomic<bool> locked{false};
+
+    ThreadBuffer();
+    ~ThreadBuffer();
+
+    void lock() {
+        while (this->locked.exchange(true, std::memory_order_acquire)) std::this_thread::yield();
+    }
+    void unlock() { this->locked.store(false, std::memory_order_release); }
+
+    // Под lock(); без активного синка записи теряются
+    void flush();
+};
+
+// Живые буферы потоков: мьютекс берётся только при старте и выходе потока
+// и при разрушении синка
+class ThreadBuffers {
+    static inline std::mutex mtx;
+    static inline std::vector<ThreadBuffer*> list;
+
+public:
+    static void add(ThreadBuffer* b) {
+        std::lock_guard<std::mutex> lock(mtx);
+        list.push_back(b);
+    }
+
+    static void remove(ThreadBuffer* b) {
+        std::lock_guard<std::mutex> lock(mtx);
+        list.erase(std::remove(list.begin(), list.end(), b), list.end());
+    }
+
+    template <typename Fn>
+    static void for_each(Fn fn) {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (ThreadBuffer* b : list) fn(*b);
+    }
+};
+
+inline thread_local ThreadBuffer tls_buffer;
+
+// Бинарный файловый логгер. Им же можно пользоваться как обычным синком
+// GLogger: текстовое сообщение пишется как запись с форматом "{}".
+class BinaryFileLogger : public ILogger {
+    std::ofstream file;
+    std::mutex mtx;
+    size_t written_formats = 0;
+
+public:
+    explicit BinaryFileLogger(const std::string& filename)
+        : file(filename.c_str(), std::ios::binary | std::ios::trunc) {
+        if (!this->file.is_open()) {
+            std::cerr << "Cannot open log file: " << filename << std::endl;
+            return;
+        }
+        this->file.write(MAGIC, sizeof(MAGIC));
+        this->file.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+
+        BinaryFileLogger* expected = nullptr;
+        active_sink.compare_exchange_strong(expected, this);
+    }
+
+    // Новые сбросы в синк прекращаются, начатые - дожидаемся, затем
+    // дописываем буферы всех живых потоков.
+    ~BinaryFileLogger() {
+        BinaryFileLogger* self = this;
+        if (active_sink.compare_exchange_strong(self, nullptr)) {
+            while (rcu::is_protected(this)) std::this_thread::yield();
+            ThreadBuffers::for_each([this](ThreadBuffer& b) {
+                b.lock();
+                if (!b.data.empty()) this->write_chunk(b.data.data(), b.data.size());
+                b.data.clear();
+                b.unlock();
+            });
+        }
+        std::lock_guard<std::mutex> lock(this->mtx);
+        if (this->file.is_open()) this->file.close();
+    }
+
+    std::string name() const override { return "binlog"; }
+
+    void log(LogLevel level, const std::string& message) override;
+
+    // Дописывает готовый кусок записей. Перед ним - ещё не записанные
+    // форматные строки, так что декодер всегда видит формат раньше записи.
+    void write_chunk(const char* data, size_t size) {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        if (!this->file.is_open()) {
+            this->sink_metrics.dropped.add();
+            return;
+        }
+
+        for (size_t total = Formats::size(); this->written_formats < total; ++this->written_formats) {
+            const char* fmt = Formats::get(static_cast<uint32_t>(this->written_formats));
+            size_t len = std::strlen(fmt);
+            if (len > UINT16_MAX) len = UINT16_MAX;
+
+            std::vector<char> rec;
+            put<uint8_t>(rec, TAG_FORMAT);
+            put<uint32_t>(rec, static_cast<uint32_t>(this->written_formats));
+            put<uint16_t>(rec, static_cast<uint16_t>(len));
+            rec.insert(rec.end(), fmt, fmt + len);
+            this->file.write(rec.data(), rec.size());
+        }
+
+        this->file.write(data, size);
+        this->file.flush();
+        this->sink_metrics.bytes.add(size);
+    }
+};
+
+inline ThreadBuffer::ThreadBuffer() {
+    // Hazard-запись потока должна пережить буфер: thread_local разрушаются
+    // в обратном порядке, а деструктор буфера сбрасывает его под rcu::Guard
+    rcu::thread_hazards();
+    this->data.reserve(FLUSH_THRESHOLD + 1024);
+    ThreadBuffers::add(this);
+}
+
+inline ThreadBuffer::~ThreadBuffer() {
+    ThreadBuffers::remove(this);
+    lock();
+    flush();
+    unlock();
+}
+
+inline void ThreadBuffer::flush() {
+    if (this->data.empty()) return;
+    {
+        rcu::Guard<BinaryFileLogger> sink(active_sink);
+        if (sink.get()) sink->write_chunk(this->data.data(), this->data.size());
+    }
+    this->data.clear();
+}
+
+// Дописывает запись в buf. Слишком длинные аргументы (больше 64 КБ
+// в сумме) отбрасываются, запись остаётся с одной форматной строкой.
+template <typename... Args>
+inline void append_record(std::vector<char>& buf, uint32_t id, LogLevel level, const Args&... args) {
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    put<uint8_t>(buf, TAG_RECORD);
+    put<uint32_t>(buf, id);
+    put<uint8_t>(buf, static_cast<uint8_t>(level));
+    put<int64_t>(buf, now);
+
+    const size_t len_pos = buf.size();
+    put<uint16_t>(buf, 0);
+    (encode(buf, args), ...);
+
+    size_t payload = buf.size() - len_pos - sizeof(uint16_t);
+    if (payload > UINT16_MAX) {
+        buf.resize(len_pos + sizeof(uint16_t));
+        payload = 0;
+    }
+    const uint16_t len = static_cast<uint16_t>(payload);
+    std::memcpy(buf.data() + len_pos, &len, sizeof(len));
+}
+
+// Горячий путь: запись в буфер потока без форматирования.
+template <typename... Args>
+inline void write(uint32_t id, LogLevel level, const Args&... args) {
+    ThreadBuffer& buf = tls_buffer;
+    buf.lock();
+    append_record(buf.data, id, level, args...);
+
+    // Ошибки сбрасываем сразу, чтобы не потерять их при падении
+    if (buf.data.size() >= FLUSH_THRESHOLD || level >= LogLevel::ERROR) {
+        buf.flush();
+    }
+    buf.unlock();
+}
+
+// То же для BINLOG: форматная строка уже зарегистрирована, fmt не нужен
+template <typename... Args>
+inline void write_fmt(uint32_t id, LogLevel level, const char* /*fmt*/, const Args&... args) {
+    write(id, level, args...);
+}
+
+// Сбросить буфер текущего потока
+inline void flush() {
+    ThreadBuffer& buf = tls_buffer;
+    buf.lock();
+    buf.flush();
+    buf.unlock();
+}
+
+inline void BinaryFileLogger::log(LogLevel level, const std::string& message) {
+    static const uint32_t id = Formats::add("{}");
+    if (active_sink.load(std::memory_order_acquire) == this) {
+        write(id, level, message);
+        return;
+    }
+
+    // Не активный синк: пишем запись мимо буферов потоков
+    std::vector<char> buf;
+    append_record(buf, id, level, message);
+    write_chunk(buf.data(), buf.size());
+}
+
+} // namespace binlog
+
+// BINLOG(LogLevel::INFO, "Worker {} step {}", id, i);
+// BINLOG(LogLevel::INFO, "Started");
+// Форматная строка - первый из __VA_ARGS__, так что вызов без аргументов
+// не требует ни ##__VA_ARGS__, ни __VA_OPT__.
+#define BINLOG_FMT_(fmt, ...) fmt
+#define BINLOG(level, ...)                                                         \
+    do {                                                                           \
+        static const uint32_t binlog_fmt_id_ =                                     \
+            ::binlog::Formats::add(BINLOG_FMT_(__VA_ARGS__, 0));                   \
+        ::binlog::write_fmt(binlog_fmt_id_, (level), __VA_ARGS__);                 \
+    } while (0)
+
+#endif // BINLOG_H
@@ -0,0 +1,179 @@
+// Декодер бинарного лога (binlog.h) в текст того же вида, что пишет FileLogger:
+//   2024-01-01 12:00:00 [INFO ] message
+//
+// Буферы потоков сбрасываются в файл кусками, поэтому записи в файле
+// перемешаны; декодер упорядочивает их по времени.
+//
+// Использование: binlog_decode app.blog [out.log]
+
+#include "binlog.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class Reader {
+    std::istream& in;
+
+public:
+    explicit Reader(std::istream& in) : in(in) {}
+
+    template <typename T>
+    bool get(T& value) {
+        return static_cast<bool>(this->in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    bool get_bytes(std::string& s, size_t len) {
+        s.resize(len);
+        return len == 0 || static_cast<bool>(this->in.read(&s[0], len));
+    }
+};
+
+// Разбор аргументов записи в текстовом виде
+static std::vector<std::string> decode_args(const std::string& payload) {
+    std::vector<std::string> args;
+    size_t pos = 0;
+
+    auto take = [&](void* dst, size_t n) {
+        if (pos + n > payload.size()) return false;
+        std::memcpy(dst, payload.data() + pos, n);
+        pos += n;
+        return true;
+    };
+
+    while (pos < payload.size()) {
+        uint8_t type = 0;
+        if (!take(&type, sizeof(type))) break;
+
+        std::ostringstream oss;
+        if (type == binlog::ARG_INT) {
+            int64_t v;
+            if (!take(&v, sizeof(v))) break;
+            oss << v;
+        } else if (type == binlog::ARG_UINT) {
+            uint64_t v;
+            if (!take(&v, sizeof(v))) break;
+            oss << v;
+        } else if (type == binlog::ARG_DOUBLE) {
+            double v;
+            if (!take(&v, sizeof(v))) break;
+            oss << v;
+        } else if (type == binlog::ARG_STRING) {
+            uint16_t len;
+            if (!take(&len, sizeof(len)) || pos + len > payload.size()) break;
+            oss.write(payload.data() + pos, len);
+            pos += len;
+        } else {
+            break;
+        }
+        args.push_back(oss.str());
+    }
+    return args;
+}
+
+// Подстановка аргументов вместо "{}"
+static std::string render(const std::string& fmt, const std::vector<std::string>& args) {
+    std::string out;
+    size_t next = 0;
+    for (size_t i = 0; i < fmt.size(); ++i) {
+        if (fmt[i] == '{' && i + 1 < fmt.size() && fmt[i + 1] == '}' && next < args.size()) {
+            out += args[next++];
+            ++i;
+        } else {
+            out += fmt[i];
+        }
+    }
+    return out;
+}
+
+static int decode(std::istream& in, std::ostream& out) {
+    Reader reader(in);
+
+    char magic[4];
+    uint32_t version = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, binlog::MAGIC, sizeof(magic)) != 0
+        || !reader.get(version) || version != binlog::VERSION) {
+        std::cerr << "Not a binlog file" << std::endl;
+        return 1;
+    }
+
+    struct Line {
+        int64_t time_ns;
+        std::string text;
+    };
+
+    std::map<uint32_t, std::string> formats;
+    std::vector<Line> lines;
+    int status = 0;
+
+    uint8_t tag;
+    while (reader.get(tag)) {
+        if (tag == binlog::TAG_FORMAT) {
+            uint32_t id;
+            uint16_t len;
+            std::string fmt;
+            if (!reader.get(id) || !reader.get(len) || !reader.get_bytes(fmt, len)) break;
+            formats[id] = fmt;
+        } else if (tag == binlog::TAG_RECORD) {
+            uint32_t id;
+            uint8_t level;
+            int64_t time_ns;
+            uint16_t len;
+            std::string payload;
+            if (!reader.get(id) || !reader.get(level) || !reader.get(time_ns)
+                || !reader.get(len) || !reader.get_bytes(payload, len)) break;
+
+            std::time_t seconds = static_cast<std::time_t>(time_ns / 1000000000);
+            char timebuf[100];
+            std::strftime(timebuf, sizeof(timebuf), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+
+            auto it = formats.find(id);
+            std::string message = it != formats.end()
+                ? render(it->second, decode_args(payload))
+                : "<unknown format " + std::to_string(id) + ">";
+
+            std::ostringstream line;
+            line << timebuf << " [" << to_string(static_cast<LogLevel>(level)) << "] " << message;
+            lines.push_back({time_ns, line.str()});
+        } else {
+            std::cerr << "Corrupted binlog: unknown tag " << int(tag) << std::endl;
+            status = 1;
+            break;
+        }
+    }
+
+    std::stable_sort(lines.begin(), lines.end(),
+                     [](const Line& a, const Line& b) { return a.time_ns < b.time_ns; });
+    for (const auto& line : lines) out << line.text << '\n';
+    return status;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <file.blog> [out.log]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    if (argc > 2) {
+        std::ofstream out(argv[2]);
+        if (!out.is_open()) {
+            std::cerr << "Cannot open " << argv[2] << std::endl;
+            return 1;
+        }
+        return decode(in, out);
+    }
+    return decode(in, std::cout);
+}
@@ -0,0 +1,294 @@
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include "metrics.h"
+#include "rcu.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Буферы записей по потокам и сборщик, сливающий их по времени.
+//
+// Каждый поток при первой записи заводит себе кольцо с одним писателем и
+// одним читателем (SPSC) и пишет только в него: общих для потоков кеш-линий
+// на пути записи нет. Поток-сборщик забирает записи из всех колец и сливает
+// их k-путевым слиянием по времени, после чего отдаёт пачкой.
+//
+// Порядок строгий, без "окна ожидания": пока поток кладёт запись, он держит
+// флаг busy и время этой записи. Сборщик выдаёт только записи не новее
+// начала раунда и не новее записи, которую кто-то кладёт прямо сейчас, -
+// более ранних записей появиться уже не может.
+//
+// Завершившийся поток помечает своё кольцо закрытым; сборщик дочитывает его
+// и только потом убирает из списка, так что записи не теряются.
+//
+// Метрики сборщика: выданные записи, глубина очереди (записей во всех кольцах
+// на начало раунда) и её максимум, задержка от записи в кольцо до выдачи.
+
+namespace collect {
+
+// Кольцо фиксированной ёмкости (степень двойки): один писатель, один читатель
+template <typename T>
+class SpscRing {
+    std::vector<T> slots;
+    size_t mask;
+
+    alignas(64) std::atomic<size_t> tail{0};  // пишет производитель
+    size_t head_cache = 0;
+    alignas(64) std::atomic<size_t> head{0};  // пишет потребитель
+    size_t tail_cache = 0;
+
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        this->slots.resize(n);
+        this->mask = n - 1;
+    }
+
+    // При заполненном кольце false, value не тронут
+    bool push(T&& value) {
+        const size_t t = this->tail.load(std::memory_order_relaxed);
+        if (t - this->head_cache > this->mask) {
+            this->head_cache = this->head.load(std::memory_order_acquire);
+            if (t - this->head_cache > this->mask) return false;
+        }
+        this->slots[t & this->mask] = std::move(value);
+        this->tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        const size_t h = this->head.load(std::memory_order_relaxed);
+        if (h == this->tail_cache) {
+            this->tail_cache = this->tail.load(std::memory_order_acquire);
+            if (h == this->tail_cache) return false;
+        }
+        out = std::move(this->slots[h & this->mask]);
+        this->head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+struct Options {
+    size_t capacity = 8192;              // записей в кольце одного потока
+    std::chrono::microseconds poll{200}; // пауза сборщика, когда забирать нечего
+};
+
+// Record - запись с полем time (system_clock::time_point).
+// Сборщик в программе один: кольцо потока хранится в thread_local.
+template <typename Record>
+class Collector {
+public:
+    using Deliver = std::function<void(std::vector<Record>&)>;
+
+private:
+    struct Buffer {
+        explicit Buffer(size_t capacity) : ring(capacity) {}
+
+        SpscRing<Record> ring;
+        alignas(64) std::atomic<bool> busy{false};
+        std::atomic<int64_t> stamp{0};       // время записи, которую кладут сейчас
+        std::atomic<bool> closed{false};     // поток завершился
+
+        std::deque<Record> pending;          // только поток сборщика
+    };
+    using Buffers = std::vector<std::shared_ptr<Buffer>>;
+
+    // Закрывает кольцо при выходе потока
+    struct Handle {
+        const Collector* owner = nullptr;
+        std::shared_ptr<Buffer> buffer;
+
+        ~Handle() {
+            if (this->buffer) this->buffer->closed.store(true, std::memory_order_release);
+        }
+    };
+
+    rcu::RcuPtr<Buffers> buffers;
+    Options opts;
+    Deliver deliver;
+
+    metrics::SinkMetrics stats;
+
+    std::atomic<bool> accepting{false};
+    std::atomic<bool> stop_flag{false};
+    std::thread worker;
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    static int64_t time_of(const Record& r) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(r.time.time_since_epoch()).count();
+    }
+
+    Buffer* local() {
+        thread_local Handle handle;
+        if (handle.owner != this || !handle.buffer) {
+            if (handle.buffer) handle.buffer->closed.store(true, std::memory_order_release);
+            handle.owner = this;
+            handle.buffer = std::make_shared<Buffer>(this->opts.capacity);
+            auto buffer = handle.buffer;
+            this->buffers.update([&](Buffers& b) { b.push_back(std::move(buffer)); });
+        }
+        return handle.buffer.get();
+    }
+
+    // Забрать кольца и переложить в batch всё, что не новее cutoff
+    void merge(bool final_round, std::vector<Record>& batch) {
+        int64_t cutoff = final_round ? std::numeric_limits<int64_t>::max() : now_ns();
+        std::vector<const Buffer*> finished;
+        {
+            auto snapshot = this->buffers.read();
+            for (const auto& b : *snapshot) {
+                if (b->busy.load(std::memory_order_seq_cst)) {
+                    cutoff = std::min(cutoff, b->stamp.load(std::memory_order_acquire));
+                }
+            }
+            uint64_t backlog = 0;
+            for (const auto& b : *snapshot) {
+                Record r;
+                while (b->ring.pop(r)) b->pending.push_back(std::move(r));
+                backlog += b->pending.size();
+            }
+            this->stats.queue_size(backlog);
+
+            // k-путевое слияние: в куче - голова очереди каждого буфера
+            using Head = std::pair<int64_t, size_t>;
+            std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+            const Buffers& list = *snapshot;
+            for (size_t i = 0; i < list.size(); ++i) {
+                if (!list[i]->pending.empty()) heads.push({time_of(list[i]->pending.front()), i});
+            }
+            while (!heads.empty() && heads.top().first <= cutoff) {
+                const size_t i = heads.top().second;
+                heads.pop();
+                auto& q = list[i]->pending;
+                batch.push_back(std::move(q.front()));
+                q.pop_front();
+                if (!q.empty()) heads.push({time_of(q.front()), i});
+            }
+
+            // Дочитанные кольца завершившихся потоков больше не нужны. Убираем
+            // ровно те, что проверены здесь: closed мог появиться после проверки,
+            // а в кольце - ещё не прочитанные записи.
+            for (const auto& b : list) {
+                if (b->closed.load(std::memory_order_acquire) && b->pending.empty()
+                    && !b->busy.load(std::memory_order_seq_cst)) {
+                    Record r;
+                    if (b->ring.pop(r)) {
+                        b->pending.push_back(std::move(r));
+                    } else {
+                        finished.push_back(b.get());
+                    }
+                }
+            }
+        }
+        // Снимок уже отпущен, и update() удалит его сразу
+        if (!finished.empty()) {
+            this->buffers.update([&](Buffers& b) {
+                b.erase(std::remove_if(b.begin(), b.end(), [&](const std::shared_ptr<Buffer>& p) {
+                    return std::find(finished.begin(), finished.end(), p.get()) != finished.end();
+                }), b.end());
+            });
+        }
+    }
+
+    // Один раунд: слить кольца и выдать результат. Снимок буферов
+    // отпускается до deliver(), чтобы поток, заводящий кольцо, не ждал синки.
+    // true - что-то было выдано.
+    bool round(bool final_round, std::vector<Record>& batch) {
+        merge(final_round, batch);
+        if (batch.empty()) return false;
+
+        const int64_t now = now_ns();
+        for (const auto& r : batch) {
+            this->stats.latency.record(static_cast<uint64_t>(std::max<int64_t>(now - time_of(r), 0)));
+        }
+        this->stats.messages.add(batch.size());
+        this->deliver(batch);
+        batch.clear();
+        return true;
+    }
+
+    bool any_busy() {
+        auto snapshot = this->buffers.read();
+        for (const auto& b : *snapshot) {
+            if (b->busy.load(std::memory_order_seq_cst)) return true;
+        }
+        return false;
+    }
+
+    void run() {
+        std::vector<Record> batch;
+        for (;;) {
+            if (this->stop_flag.load(std::memory_order_acquire) && !any_busy()) {
+                // Новых записей уже не будет: выдаём остаток целиком
+                round(true, batch);
+                this->stats.queue_size(0);
+                return;
+            }
+            if (!round(false, batch)) std::this_thread::sleep_for(this->opts.poll);
+        }
+    }
+
+public:
+    ~Collector() { stop(); }
+
+    bool running() const { return this->accepting.load(std::memory_order_relaxed); }
+
+    const metrics::SinkMetrics& metrics() const { return this->stats; }
+
+    void start(Deliver deliver_fn, Options options = Options()) {
+        stop();
+        this->opts = options;
+        this->deliver = std::move(deliver_fn);
+        this->stop_flag.store(false, std::memory_order_relaxed);
+        this->worker = std::thread(&Collector::run, this);
+        this->accepting.store(true, std::memory_order_seq_cst);
+    }
+
+    // Дожидается, пока сборщик выдаст все принятые записи
+    void stop() {
+        if (!this->worker.joinable()) return;
+        this->accepting.store(false, std::memory_order_seq_cst);
+        this->stop_flag.store(true, std::memory_order_release);
+        this->worker.join();
+    }
+
+    // Положить запись в кольцо своего потока; время ставится здесь.
+    // false - режим выключен, запись не тронута. При полном кольце ждёт сборщик.
+    bool push(Record&& record) {
+        if (!this->accepting.load(std::memory_order_relaxed)) return false;
+
+        Buffer* b = local();
+        b->busy.store(true, std::memory_order_seq_cst);
+        if (!this->accepting.load(std::memory_order_seq_cst)) {
+            b->busy.store(false, std::memory_order_release);
+            return false;
+        }
+
+        record.time = std::chrono::system_clock::now();
+        b->stamp.store(time_of(record), std::memory_order_release);
+        while (!b->ring.push(std::move(record))) std::this_thread::yield();
+        b->busy.store(false, std::memory_order_seq_cst);
+        return true;
+    }
+};
+
+} // namespace collect
+
+#endif // COLLECTOR_H
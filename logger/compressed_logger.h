@@ -0,0 +1,216 @@
+#ifndef COMPRESSED_LOGGER_H
+#define COMPRESSED_LOGGER_H
+
+#include "iface.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+// Файловый логгер со сжатием кадрами (zlib, уровень 1). Нужен -lz.
+//
+// Пишущий поток только форматирует строку и дописывает её в буфер под
+// коротким мьютексом. Когда буфер набрал frame_size байт (или прошло
+// flush_interval), фоновый поток сжимает его в отдельный кадр и пишет в файл.
+//
+// Каждый кадр сжат независимо и начинается с маркера - это точка
+// синхронизации: файл после падения читается до последнего целого кадра,
+// а испорченный кадр пропускается поиском следующего маркера (zlog_cat).
+//
+// Формат файла:
+//   "ZLOG" u32 version
+//   кадр: u32 FRAME_MAGIC u32 raw_size u32 packed_size u32 crc32(packed) <packed>
+// Числа в порядке байт хоста; packed - поток zlib (compress2).
+// raw_size не больше MAX_FRAME: frame_size ограничен MAX_FRAME / 2, длинные
+// сообщения обрезаются.
+
+namespace zlog {
+
+constexpr char     MAGIC[4]    = {'Z', 'L', 'O', 'G'};
+constexpr uint32_t VERSION     = 1;
+constexpr uint32_t FRAME_MAGIC = 0x4D52465A;  // "ZFRM"
+
+// Предел raw_size кадра. crc заголовок не покрывает, и читатель по этому
+// пределу отбрасывает испорченные размеры, не выделяя под них память.
+constexpr size_t MAX_FRAME = 64 * 1024 * 1024;
+
+struct FrameHeader {
+    uint32_t magic;
+    uint32_t raw_size;
+    uint32_t packed_size;
+    uint32_t crc;
+};
+
+} // namespace zlog
+
+class CompressedFileLogger : public ILogger {
+public:
+    struct Options {
+        size_t frame_size = 256 * 1024;
+        std::chrono::milliseconds flush_interval{1000};
+        // Сколько заполненных буферов может ждать сжатия; дальше - потери
+        size_t max_pending = 16;
+        int level = 1;
+    };
+
+private:
+    Options opts;
+    FILE* file = nullptr;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::string active;
+    size_t active_lines = 0;
+    std::deque<std::string> pending;
+    std::vector<std::string> spare;
+    bool stop = false;
+    std::thread worker;
+
+    // Пустой буфер под следующий кадр, по возможности уже сжатый ранее
+    std::string next_buffer() {
+        std::string buf;
+        if (!this->spare.empty()) {
+            buf = std::move(this->spare.back());
+            this->spare.pop_back();
+        } else {
+            buf.reserve(this->opts.frame_size + 256);
+        }
+        return buf;
+    }
+
+    void write_frame(const std::string& raw, std::vector<unsigned char>& packed) {
+        uLongf packed_size = compressBound(static_cast<uLong>(raw.size()));
+        packed.resize(packed_size);
+        if (compress2(packed.data(), &packed_size, reinterpret_cast<const Bytef*>(raw.data()),
+                      static_cast<uLong>(raw.size()), this->opts.level) != Z_OK) {
+            this->sink_metrics.dropped.add();
+            return;
+        }
+
+        zlog::FrameHeader h;
+        h.magic = zlog::FRAME_MAGIC;
+        h.raw_size = static_cast<uint32_t>(raw.size());
+        h.packed_size = static_cast<uint32_t>(packed_size);
+        h.crc = static_cast<uint32_t>(crc32(0L, packed.data(), static_cast<uInt>(packed_size)));
+
+        std::fwrite(&h, sizeof(h), 1, this->file);
+        std::fwrite(packed.data(), 1, packed_size, this->file);
+        std::fflush(this->file);
+        this->sink_metrics.bytes.add(sizeof(h) + packed_size);
+    }
+
+    void run() {
+        std::vector<unsigned char> packed;
+        std::deque<std::string> frames;
+
+        std::unique_lock<std::mutex> lock(this->mtx);
+        for (;;) {
+            this->cv.wait_for(lock, this->opts.flush_interval,
+                              [this] { return this->stop || !this->pending.empty(); });
+
+            // По таймеру или при остановке сжимаем и недобранный буфер
+            if (this->pending.empty() && !this->active.empty()) {
+                this->pending.push_back(std::move(this->active));
+                this->active = next_buffer();
+                this->active_lines = 0;
+            }
+            frames.swap(this->pending);
+            this->sink_metrics.queue_size(0);
+            const bool done = this->stop;
+            lock.unlock();
+
+            for (auto& raw : frames) {
+                write_frame(raw, packed);
+                raw.clear();
+            }
+
+            lock.lock();
+            for (auto& raw : frames) this->spare.push_back(std::move(raw));
+            frames.clear();
+            if (done && this->pending.empty() && this->active.empty()) return;
+        }
+    }
+
+public:
+    explicit CompressedFileLogger(const std::string& filename)
+        : CompressedFileLogger(filename, Options()) {}
+
+    CompressedFileLogger(const std::string& filename, Options options) : opts(options) {
+        this->file = std::fopen(filename.c_str(), "wb");
+        if (!this->file) {
+            std::cerr << "Cannot open log file: " << filename << std::endl;
+            return;
+        }
+        std::fwrite(zlog::MAGIC, sizeof(zlog::MAGIC), 1, this->file);
+        std::fwrite(&zlog::VERSION, sizeof(zlog::VERSION), 1, this->file);
+
+        this->opts.frame_size = std::min(this->opts.frame_size, zlog::MAX_FRAME / 2);
+        this->active.reserve(this->opts.frame_size + 256);
+        this->worker = std::thread(&CompressedFileLogger::run, this);
+    }
+
+    // Дописывает и сжимает всё, что осталось
+    ~CompressedFileLogger() {
+        if (!this->file) return;
+        {
+            std::lock_guard<std::mutex> lock(this->mtx);
+            this->stop = true;
+        }
+        this->cv.notify_one();
+        this->worker.join();
+        std::fclose(this->file);
+    }
+
+    std::string name() const override { return "zlog"; }
+
+    void log(LogLevel level, const std::string& message) override {
+        if (!this->file) {
+            this->sink_metrics.dropped.add();
+            return;
+        }
+
+        char prefix[128];
+        size_t len = local_timestamp(prefix);
+        len += std::snprintf(prefix + len, sizeof(prefix) - len, " [%s] ", to_string(level));
+        // Буфер до записи меньше frame_size, так что кадр не выйдет за MAX_FRAME
+        const size_t body = std::min(message.size(), zlog::MAX_FRAME / 2 - sizeof(prefix) - 1);
+
+        bool notify = false;
+        {
+            std::lock_guard<std::mutex> lock(this->mtx);
+            this->active.append(prefix, len);
+            this->active.append(message, 0, body);
+            this->active += '\n';
+            ++this->active_lines;
+
+            if (this->active.size() >= this->opts.frame_size) {
+                if (this->pending.size() >= this->opts.max_pending) {
+                    // Сжатие не успевает: теряем буфер целиком, а не копим память
+                    this->sink_metrics.dropped.add(this->active_lines);
+                    this->active.clear();
+                    this->active_lines = 0;
+                    return;
+                }
+                this->pending.push_back(std::move(this->active));
+                this->active_lines = 0;
+                this->sink_metrics.queue_size(this->pending.size());
+                this->active = next_buffer();
+                notify = true;
+            }
+        }
+        if (notify) this->cv.notify_one();
+    }
+};
+
+#endif // COMPRESSED_LOGGER_H
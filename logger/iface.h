@@ -1,6 +1,17 @@
 #ifndef IFACE_H
 #define IFACE_H
 
+#include "collector.h"
+#include "metrics.h"
+#include "policies.h"
+#include "rcu.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -23,11 +34,60 @@ inline const char* to_string(LogLevel level) {
     return "?????";
 }
 
+// Местное время текущей секунды "YYYY-MM-DD HH:MM:SS" в out (не меньше 32
+// байт), возвращает длину. localtime_r берёт глобальную блокировку часового
+// пояса, поэтому строка форматируется раз в секунду на поток.
+inline size_t local_timestamp(char* out) {
+    thread_local std::time_t cached_sec = -1;
+    thread_local char stamp[32];
+    thread_local size_t stamp_len = 0;
+
+    std::time_t now = std::time(nullptr);
+    if (now != cached_sec) {
+        std::tm tm_now;
+#ifndef _WIN32
+        localtime_r(&now, &tm_now);
+#else
+        localtime_s(&tm_now, &now);
+#endif
+        stamp_len = std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm_now);
+        cached_sec = now;
+    }
+    std::memcpy(out, stamp, stamp_len);
+    return stamp_len;
+}
+
+// Запись для пакетной передачи в синк
+struct LogRecord {
+    LogLevel level;
+    std::chrono::system_clock::time_point time;
+    std::string message;
+};
+
 class ILogger {
+protected:
+    metrics::SinkMetrics sink_metrics;
+
 public:
     virtual ~ILogger() = default;
     virtual void log(LogLevel level, const std::string& message) = 0;
 
+    // Имя синка в метриках
+    virtual std::string name() const { return "sink"; }
+
+    metrics::SinkMetrics& metrics() { return this->sink_metrics; }
+    const metrics::SinkMetrics& metrics() const { return this->sink_metrics; }
+
+    // Снимки метрик для GLogger::stats(); обёртки добавляют и вложенные синки
+    virtual void collect_stats(std::vector<metrics::SinkStats>& out) const {
+        out.push_back(metrics::snapshot(name(), this->sink_metrics));
+    }
+
+    // Пакет записей; синки, умеющие писать пачкой, переопределяют
+    virtual void log_batch(const LogRecord* records, size_t count) {
+        for (size_t i = 0; i < count; ++i) log(records[i].level, records[i].message);
+    }
+
     void debug(const std::string& msg)    { log(LogLevel::DEBUG,    msg); }
     void info(const std::string& msg)     { log(LogLevel::INFO,     msg); }
     void warning(const std::string& msg)  { log(LogLevel::WARNING,  msg); }
@@ -35,21 +95,268 @@ public:
     void critical(const std::string& msg) { log(LogLevel::CRITICAL, msg); }
 };
 
+// Глобальный логгер. Список синков - неизменяемый снимок (rcu.h):
+// log() читает его без блокировок, add/remove/replace подменяют снимок
+// целиком. Синк разрушается, когда его не держит ни снимок, ни читатель.
+//
+// Перед синками сообщение проходит политики защиты от шторма (policies.h).
+// Лимит на место вызова работает только через макросы GLOG_*.
+//
+// В режиме буферов по потокам (start_collector) сообщения после политик
+// идут в кольцо своего потока, а синкам их пачками по времени отдаёт
+// поток-сборщик (collector.h).
 class GLogger {
+public:
+    using Sinks = std::vector<std::shared_ptr<ILogger>>;
+
 private:
-    static inline std::vector<ILogger*> loggers;
+    static inline rcu::RcuPtr<Sinks> sinks;
+    static inline policy::StormPolicy storm;
+
+    static inline metrics::ShardedCounter level_messages[metrics::LEVELS];
+    static inline metrics::ShardedCounter sampled_out;
+    static inline metrics::ShardedCounter collapsed;
+    static inline metrics::ShardedCounter rate_limited;
+    static inline std::atomic<bool> timing{true};
+
+    static inline collect::Collector<LogRecord> collector;
+    // После collector: потоки отчётов останавливаются раньше, чем он разрушится
+    static inline metrics::Reporter reporter;
+    static inline metrics::Reporter repeat_flusher;
+
+    static void dispatch(LogLevel level, const std::string& message) {
+        auto snapshot = sinks.read();
+        const bool timed = timing.load(std::memory_order_relaxed);
+        for (const auto& logger : *snapshot) {
+            if (!logger) continue;
+            logger->metrics().messages.add();
+            if (!timed) {
+                logger->log(level, message);
+                continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            logger->log(level, message);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            logger->metrics().latency.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    // Пачка от сборщика; задержка на запись - средняя по пачке, как в AsyncLogger
+    static void dispatch_batch(std::vector<LogRecord>& batch) {
+        auto snapshot = sinks.read();
+        const bool timed = timing.load(std::memory_order_relaxed);
+        for (const auto& logger : *snapshot) {
+            if (!logger) continue;
+            logger->metrics().messages.add(batch.size());
+            if (!timed) {
+                logger->log_batch(batch.data(), batch.size());
+                continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            logger->log_batch(batch.data(), batch.size());
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            logger->metrics().latency.record(static_cast<uint64_t>(elapsed) / batch.size(), batch.size());
+        }
+    }
+
+    // В синки напрямую или через буфер потока, если сборщик запущен.
+    // Запись (копия сообщения) создаётся только во втором случае.
+    static void emit(LogLevel level, const std::string& message) {
+        if (collector.running()) {
+            LogRecord record{level, {}, message};
+            if (collector.push(std::move(record))) return;
+        }
+        dispatch(level, message);
+    }
+
+    // Для места вызова в отчёте - file:line: отчёт может выйти намного
+    // позже самого сообщения и вперемешку с другими
+    static void report_repeats(size_t level, uint64_t count, const policy::CallSite* site = nullptr) {
+        if (count == 0) return;
+        std::string text = "last message repeated " + std::to_string(count) + " times";
+        if (site) text += " at " + std::string(site->file) + ":" + std::to_string(site->line);
+        emit(static_cast<LogLevel>(level), text);
+    }
+
+    // true - сообщение проходит все политики. Если перед ним что-то было
+    // отброшено лимитами, в suppressed - сколько.
+    static bool admit(LogLevel level, const std::string& message, policy::CallSite* site,
+                      uint64_t& suppressed) {
+        const size_t lvl = static_cast<size_t>(level);
+        suppressed = 0;
+
+        if (!storm.sampler.allow(lvl)) {
+            sampled_out.add();
+            return false;
+        }
+
+        // Повторы схлопываем раньше лимитов, чтобы они попали в счётчик
+        uint64_t pending = 0;
+        size_t pending_level = 0;
+        if (storm.repeats.check(lvl, message, site ? &site->repeats : nullptr, pending, pending_level)) {
+            collapsed.add();
+            return false;
+        }
+        report_repeats(pending_level, pending, site);
+
+        const int64_t now = policy::now_ns();
+        if (!storm.level_limits[lvl].allow(storm.level_limiters[lvl], now)) {
+            storm.level_suppressed[lvl].fetch_add(1, std::memory_order_relaxed);
+            rate_limited.add();
+            return false;
+        }
+        if (site && !storm.call_site_limit.allow(site->limiter, now)) {
+            site->suppressed.fetch_add(1, std::memory_order_relaxed);
+            rate_limited.add();
+            return false;
+        }
+
+        if (storm.level_suppressed[lvl].load(std::memory_order_relaxed)) {
+            suppressed += storm.level_suppressed[lvl].exchange(0, std::memory_order_relaxed);
+        }
+        if (site && site->suppressed.load(std::memory_order_relaxed)) {
+            suppressed += site->suppressed.exchange(0, std::memory_order_relaxed);
+        }
+        level_messages[lvl].add();
+        return true;
+    }
 
 public:
-    static void add(ILogger* logger) {
-        if (logger) loggers.push_back(logger);
+    static void add(std::shared_ptr<ILogger> logger) {
+        if (!logger) return;
+        sinks.update([&](Sinks& s) { s.push_back(std::move(logger)); });
+    }
+
+    // remove/replace/clear ждут, пока потоки, пишущие в этот момент,
+    // выйдут из старого снимка: после возврата GLogger убранный синк не
+    // держит (если вызвать их из log() синка, - только после следующей
+    // записи). Поэтому вызывать их нельзя под мьютексом, который берёт log()
+    // какого-нибудь синка.
+    static bool remove(const ILogger* logger) {
+        bool removed = false;
+        sinks.update([&](Sinks& s) {
+            auto it = std::remove_if(s.begin(), s.end(),
+                                     [&](const std::shared_ptr<ILogger>& p) { return p.get() == logger; });
+            removed = it != s.end();
+            s.erase(it, s.end());
+        });
+        return removed;
+    }
+
+    static bool replace(const ILogger* old_logger, std::shared_ptr<ILogger> new_logger) {
+        bool replaced = false;
+        sinks.update([&](Sinks& s) {
+            for (auto& p : s) {
+                if (p.get() == old_logger) {
+                    p = std::move(new_logger);
+                    replaced = true;
+                    break;
+                }
+            }
+        });
+        return replaced;
+    }
+
+    static void clear() {
+        sinks.store(std::make_unique<Sinks>());
+    }
+
+    static void log(LogLevel level, const std::string& message, policy::CallSite* site = nullptr) {
+        uint64_t suppressed = 0;
+        if (!admit(level, message, site, suppressed)) return;
+
+        if (suppressed == 0) {
+            emit(level, message);
+        } else {
+            emit(level, message + " [" + std::to_string(suppressed) + " suppressed by rate limit]");
+        }
+    }
+
+    // Режим буферов по потокам: каждый поток пишет в своё кольцо, сборщик
+    // сливает их по времени и отдаёт синкам через log_batch
+    static void start_collector(collect::Options options = collect::Options()) {
+        collector.start(dispatch_batch, options);
+    }
+
+    // Выдаёт синкам всё принятое и возвращает прямую запись
+    static void stop_collector() {
+        collector.stop();
+    }
+
+    // Лимит на уровень: per_second сообщений в секунду, всплеск до burst; 0 - снять
+    static void set_rate_limit(LogLevel level, double per_second, unsigned burst) {
+        storm.level_limits[static_cast<size_t>(level)].set(per_second, burst);
     }
 
-    static void log(LogLevel level, const std::string& message) {
-        for (auto logger : loggers) {
-            if (logger) logger->log(level, message);
+    // Лимит на каждое место вызова GLOG_*
+    static void set_call_site_rate_limit(double per_second, unsigned burst) {
+        storm.call_site_limit.set(per_second, burst);
+    }
+
+    // Доля пропускаемых сообщений для DEBUG/INFO; WARNING и выше не сэмплируются
+    static void set_sampling(LogLevel level, double rate) {
+        if (level >= LogLevel::WARNING) return;
+        storm.sampler.set(static_cast<size_t>(level), rate);
+    }
+
+    // Накопленные повторы выдаются, когда место вызова пишет другое
+    // сообщение, и не реже раза в flush_interval (см. flush)
+    static void set_collapse_repeats(bool enabled,
+                                     std::chrono::milliseconds flush_interval = std::chrono::milliseconds(1000)) {
+        storm.repeats.enable(enabled);
+        if (enabled) {
+            repeat_flusher.start(flush_interval, [] { flush(); });
+        } else {
+            repeat_flusher.stop();
+            flush();
         }
     }
 
+    // Замер задержки log() каждого синка (два чтения steady_clock на синк)
+    static void set_sink_timing(bool enabled) {
+        timing.store(enabled, std::memory_order_relaxed);
+    }
+
+    static metrics::LoggerStats stats() {
+        metrics::LoggerStats s;
+        for (size_t i = 0; i < metrics::LEVELS; ++i) s.messages[i] = level_messages[i].get();
+        s.sampled_out = sampled_out.get();
+        s.collapsed = collapsed.get();
+        s.rate_limited = rate_limited.get();
+
+        auto snapshot = sinks.read();
+        for (const auto& logger : *snapshot) {
+            if (logger) logger->collect_stats(s.sinks);
+        }
+        if (collector.running() || collector.metrics().messages.get()) {
+            s.sinks.push_back(metrics::snapshot("collector", collector.metrics()));
+        }
+        return s;
+    }
+
+    // Раз в interval писать metrics::format(stats()) в лог на уровне level
+    static void start_metrics_reporter(std::chrono::milliseconds interval, LogLevel level = LogLevel::INFO) {
+        reporter.start(interval, [level] { emit(level, metrics::format(stats())); });
+    }
+
+    static void stop_metrics_reporter() {
+        reporter.stop();
+    }
+
+    // Выдать накопленное "last message repeated N times" всех мест вызова
+    static void flush() {
+        size_t level = 0;
+        uint64_t count = storm.repeats.flush(level);
+        report_repeats(level, count);
+        policy::for_each_call_site([](policy::CallSite& site) {
+            size_t site_level = 0;
+            uint64_t site_count = site.repeats.flush(site_level);
+            report_repeats(site_level, site_count, &site);
+        });
+    }
+
     static void debug(const std::string& msg)    { log(LogLevel::DEBUG,    msg); }
     static void info(const std::string& msg)     { log(LogLevel::INFO,     msg); }
     static void warning(const std::string& msg)  { log(LogLevel::WARNING,  msg); }
@@ -57,4 +364,17 @@ public:
     static void critical(const std::string& msg) { log(LogLevel::CRITICAL, msg); }
 };
 
+// Логирование с учётом места вызова (для лимита на место вызова)
+#define GLOG(level, msg)                                                           \
+    do {                                                                           \
+        static ::policy::CallSite glog_site_(__FILE__, __LINE__);                  \
+        ::GLogger::log((level), (msg), &glog_site_);                               \
+    } while (0)
+
+#define GLOG_DEBUG(msg)    GLOG(LogLevel::DEBUG,    msg)
+#define GLOG_INFO(msg)     GLOG(LogLevel::INFO,     msg)
+#define GLOG_WARNING(msg)  GLOG(LogLevel::WARNING,  msg)
+#define GLOG_ERROR(msg)    GLOG(LogLevel::ERROR,    msg)
+#define GLOG_CRITICAL(msg) GLOG(LogLevel::CRITICAL, msg)
+
 #endif // IFACE_H
\ No newline at end of file
@@ -4,8 +4,10 @@
 #include "iface.h"
 #include <fstream>
 #include <sstream>
+#include <cstring>
 #include <ctime>
 #include <iostream>
+#include <mutex>
 
 #ifndef _WIN32
     #include <syslog.h>
@@ -14,6 +16,8 @@
 // Консольный логгер с цветами (Linux/macOS)
 class ConsoleLogger : public ILogger {
 public:
+    std::string name() const override { return "console"; }
+
     void log(LogLevel level, const std::string& message) override {
         std::ostringstream oss;
         oss << "[" << to_string(level) << "] " << message;
@@ -31,12 +35,14 @@ public:
 #else
         std::cout << oss.str() << std::endl;
 #endif
+        this->sink_metrics.bytes.add(oss.str().size() + 1);
     }
 };
 
-// Файловый логгер
+// Файловый логгер. Пишется из нескольких потоков, поэтому под мьютексом.
 class FileLogger : public ILogger {
     std::ofstream file;
+    std::mutex mtx;
 public:
     explicit FileLogger(const std::string& filename) : file(filename.c_str()) {
         if (!this->file.is_open()) {
@@ -44,15 +50,22 @@ public:
         }
     }
 
+    std::string name() const override { return "file"; }
+
     void log(LogLevel level, const std::string& message) override {
-        if (!this->file.is_open()) return;
+        if (!this->file.is_open()) {
+            this->sink_metrics.dropped.add();
+            return;
+        }
 
-        std::time_t now = std::time(nullptr);
-        char timebuf[100];
-        std::strftime(timebuf, sizeof(timebuf), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
+        char timebuf[32];
+        const size_t timelen = local_timestamp(timebuf);
 
-        this->file << timebuf << " [" << to_string(level) << "] " << message << std::endl;
+        std::lock_guard<std::mutex> lock(this->mtx);
+        this->file.write(timebuf, timelen);
+        this->file << " [" << to_string(level) << "] " << message << std::endl;
         this->file.flush();
+        this->sink_metrics.bytes.add(timelen + 10 + message.size());
     }
 
     ~FileLogger() {
@@ -67,6 +80,8 @@ public:
     SyslogLogger() { openlog("CppLoggerApp", LOG_PID, LOG_USER); }
     ~SyslogLogger() { closelog(); }
 
+    std::string name() const override { return "syslog"; }
+
     void log(LogLevel level, const std::string& message) override {
         int priority = LOG_INFO;
         switch (level) {
@@ -77,6 +92,7 @@ public:
             case LogLevel::CRITICAL: priority = LOG_CRIT; break;
         }
         syslog(priority, "%s", message.c_str());
+        this->sink_metrics.bytes.add(message.size());
     }
 };
 #endif
@@ -1,5 +1,6 @@
 #include "iface.h"
 #include "loggers.h"
+#include "binlog.h"
 
 #include <thread>
 #include <vector>
@@ -29,11 +30,15 @@ void worker(int id) {
         std::ostringstream step;
         step << "Worker " << id << " processing step " << i;
         GLogger::info(step.str());
+        BINLOG(LogLevel::DEBUG, "Worker {} hot path, step {}", id, i);
         std::this_thread::sleep_for(std::chrono::milliseconds(200));
     }
 
     if (id == 2) {
-        GLogger::error("Something went wrong in worker 2!");
+        // Одинаковые ошибки схлопываются в "last message repeated N times"
+        for (int i = 0; i < 1000; ++i) {
+            GLOG_ERROR("Something went wrong in worker 2!");
+        }
     }
 
     std::ostringstream fin;
@@ -42,17 +47,20 @@ void worker(int id) {
 }
 
 int main() {
-    ConsoleLogger* console = new ConsoleLogger();
-    FileLogger* file = new FileLogger("app.log");
-
-    GLogger::add(console);
-    GLogger::add(file);
+    GLogger::add(std::make_shared<ConsoleLogger>());
+    GLogger::add(std::make_shared<FileLogger>("app.log"));
+    GLogger::add(std::make_shared<binlog::BinaryFileLogger>("app.blog"));
 
 #ifdef __linux__
-    SyslogLogger* syslog = new SyslogLogger();
-    GLogger::add(syslog);
+    GLogger::add(std::make_shared<SyslogLogger>());
 #endif
 
+    GLogger::set_collapse_repeats(true);
+    GLogger::set_call_site_rate_limit(100, 20);
+    GLogger::set_sampling(LogLevel::DEBUG, 0.1);
+
+    GLogger::start_metrics_reporter(std::chrono::milliseconds(500));
+
     GLogger::info("Application started");
 
     std::vector<std::thread> threads;
@@ -63,12 +71,13 @@ int main() {
     for (auto& t : threads) t.join();
 
     GLogger::info("Application finished");
+    GLogger::flush();
 
-    delete console;
-    delete file;
-#ifdef __linux__
-    delete syslog;
-#endif
+    GLogger::stop_metrics_reporter();
+    GLogger::info(metrics::format(GLogger::stats()));
+
+    // Синки разрушаются здесь, пока живы буферы потока main
+    GLogger::clear();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,244 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Метрики логгера: счётчики и гистограммы задержек.
+//
+// Запись - relaxed атомарные операции. Общие для всех потоков счётчики
+// разнесены по кеш-линиям (ShardedCounter), чтобы потоки не дрались за одну.
+// Чтение - снимок (Stats), значения в нём согласованы только приблизительно.
+
+namespace metrics {
+
+constexpr size_t LEVELS = 5;
+
+// Счётчик, разбитый на шарды по потокам
+class ShardedCounter {
+    static constexpr size_t SHARDS = 16;
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard shards[SHARDS];
+
+    static size_t shard_index() {
+        thread_local size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % SHARDS;
+        return index;
+    }
+
+public:
+    void add(uint64_t n = 1) {
+        this->shards[shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t get() const {
+        uint64_t sum = 0;
+        for (const auto& s : this->shards) sum += s.value.load(std::memory_order_relaxed);
+        return sum;
+    }
+};
+
+// Гистограмма в наносекундах: 8 подкорзин на каждую степень двойки,
+// погрешность перцентиля - не больше 12.5%.
+class LatencyHistogram {
+    static constexpr int SUB_BITS = 3;
+    static constexpr size_t SUB = size_t(1) << SUB_BITS;
+    static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB;
+
+    std::atomic<uint64_t> buckets[BUCKETS] = {};
+    std::atomic<uint64_t> max_ns{0};
+
+    static size_t index_of(uint64_t v) {
+        if (v < SUB) return static_cast<size_t>(v);
+        int e = 63 - __builtin_clzll(v);
+        size_t sub = static_cast<size_t>(v >> (e - SUB_BITS)) & (SUB - 1);
+        return static_cast<size_t>(e - SUB_BITS + 1) * SUB + sub;
+    }
+
+    // Верхняя граница корзины
+    static uint64_t upper_bound(size_t i) {
+        if (i < SUB) return i;
+        int e = static_cast<int>(i / SUB) + SUB_BITS - 1;
+        uint64_t sub = i % SUB;
+        uint64_t low = (uint64_t(1) << e) | (sub << (e - SUB_BITS));
+        return low + (uint64_t(1) << (e - SUB_BITS)) - 1;
+    }
+
+public:
+    // count одинаковых значений (например, средняя задержка по пачке)
+    void record(uint64_t ns, uint64_t count = 1) {
+        if (count == 0) return;
+        this->buckets[index_of(ns)].fetch_add(count, std::memory_order_relaxed);
+        uint64_t m = this->max_ns.load(std::memory_order_relaxed);
+        while (ns > m && !this->max_ns.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t count() const {
+        uint64_t n = 0;
+        for (const auto& b : this->buckets) n += b.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    uint64_t max() const { return this->max_ns.load(std::memory_order_relaxed); }
+
+    // Добавить значения другой гистограммы (например, собранной одним потоком)
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            uint64_t n = other.buckets[i].load(std::memory_order_relaxed);
+            if (n) this->buckets[i].fetch_add(n, std::memory_order_relaxed);
+        }
+        uint64_t m = this->max_ns.load(std::memory_order_relaxed);
+        const uint64_t om = other.max();
+        while (om > m && !this->max_ns.compare_exchange_weak(m, om, std::memory_order_relaxed)) {}
+    }
+
+    // q в [0, 1]
+    uint64_t percentile(double q) const {
+        uint64_t counts[BUCKETS];
+        uint64_t total = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            counts[i] = this->buckets[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if (total == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(upper_bound(i), max());
+        }
+        return max();
+    }
+};
+
+// Метрики одного синка. Задержку log() и число сообщений считает GLogger,
+// байты и потери - сам синк, очередь - асинхронные синки.
+struct SinkMetrics {
+    ShardedCounter messages;
+    LatencyHistogram latency;
+    ShardedCounter bytes;
+    ShardedCounter dropped;
+    std::atomic<uint64_t> queue_depth{0};
+    std::atomic<uint64_t> queue_high_water{0};
+
+    void queue_size(uint64_t depth) {
+        this->queue_depth.store(depth, std::memory_order_relaxed);
+        uint64_t hw = this->queue_high_water.load(std::memory_order_relaxed);
+        while (depth > hw && !this->queue_high_water.compare_exchange_weak(hw, depth, std::memory_order_relaxed)) {}
+    }
+};
+
+// Снимок метрик синка
+struct SinkStats {
+    std::string name;
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    uint64_t dropped = 0;
+    uint64_t queue_depth = 0;
+    uint64_t queue_high_water = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+inline SinkStats snapshot(const std::string& name, const SinkMetrics& m) {
+    SinkStats s;
+    s.name = name;
+    s.messages = m.messages.get();
+    s.bytes = m.bytes.get();
+    s.dropped = m.dropped.get();
+    s.queue_depth = m.queue_depth.load(std::memory_order_relaxed);
+    s.queue_high_water = m.queue_high_water.load(std::memory_order_relaxed);
+    s.p50_ns = m.latency.percentile(0.50);
+    s.p99_ns = m.latency.percentile(0.99);
+    s.p999_ns = m.latency.percentile(0.999);
+    s.max_ns = m.latency.max();
+    return s;
+}
+
+// Снимок метрик GLogger
+struct LoggerStats {
+    uint64_t messages[LEVELS] = {};   // прошли политики, по уровням
+    uint64_t sampled_out = 0;
+    uint64_t collapsed = 0;
+    uint64_t rate_limited = 0;
+    std::vector<SinkStats> sinks;
+};
+
+// Метрики в одну строку, для периодического вывода в лог
+inline std::string format(const LoggerStats& s) {
+    static const char* names[LEVELS] = {"debug", "info", "warning", "error", "critical"};
+
+    std::ostringstream oss;
+    oss << "logger stats:";
+    for (size_t i = 0; i < LEVELS; ++i) oss << ' ' << names[i] << '=' << s.messages[i];
+    oss << " sampled_out=" << s.sampled_out
+        << " collapsed=" << s.collapsed
+        << " rate_limited=" << s.rate_limited;
+
+    for (const auto& k : s.sinks) {
+        oss << " | " << k.name
+            << ": msgs=" << k.messages
+            << " bytes=" << k.bytes
+            << " dropped=" << k.dropped;
+        if (k.queue_high_water) {
+            oss << " queue=" << k.queue_depth << " queue_hw=" << k.queue_high_water;
+        }
+        oss << " p50=" << k.p50_ns / 1000.0 << "us"
+            << " p99=" << k.p99_ns / 1000.0 << "us"
+            << " p999=" << k.p999_ns / 1000.0 << "us"
+            << " max=" << k.max_ns / 1000.0 << "us";
+    }
+    return oss.str();
+}
+
+// Фоновый поток, раз в interval вызывающий report
+class Reporter {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread thread;
+    bool stop_flag = false;
+
+public:
+    ~Reporter() { stop(); }
+
+    void start(std::chrono::milliseconds interval, std::function<void()> report) {
+        stop();
+        this->stop_flag = false;
+        this->thread = std::thread([this, interval, report] {
+            std::unique_lock<std::mutex> lock(this->mtx);
+            while (!this->cv.wait_for(lock, interval, [this] { return this->stop_flag; })) {
+                lock.unlock();
+                report();
+                lock.lock();
+            }
+        });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(this->mtx);
+            this->stop_flag = true;
+        }
+        this->cv.notify_one();
+        if (this->thread.joinable()) this->thread.join();
+    }
+};
+
+} // namespace metrics
+
+#endif // METRICS_H
@@ -0,0 +1,335 @@
+#ifndef MMAP_LOGGER_H
+#define MMAP_LOGGER_H
+
+#include "iface.h"
+#include "rcu.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Файловый логгер поверх mmap с ротацией (только Linux).
+//
+// Лог пишется сегментами фиксированного размера: prefix.000001.log, ...
+// Каждый сегмент заранее выделяется fallocate и отображается в память,
+// запись - это fetch_add позиции и memcpy в отображение.
+//
+// Фоновый поток держит наготове несколько следующих сегментов, закрывает
+// старые (обрезая их до реальной длины), периодически делает msync и удаляет
+// лишние старые файлы. Поток, запись которого не влезла в сегмент, просто
+// подменяет текущий сегмент заготовленным и никогда не открывает файлы сам:
+// если заготовки кончились, записи теряются (dropped), пока фоновый поток
+// не поставит новый сегмент.
+//
+// Страницы MAP_SHARED принадлежат ядру, поэтому при падении процесса данные
+// не теряются; при падении системы теряется только хвост после последнего
+// msync. Незакрытый сегмент дополнен нулевыми байтами до конца.
+class MmapFileLogger : public ILogger {
+public:
+    struct Options {
+        std::string prefix = "app";
+        size_t segment_size = 16 * 1024 * 1024;
+        // Ротация по времени; 0 - только по размеру
+        std::chrono::seconds rotate_interval{0};
+        // Сколько закрытых файлов хранить
+        size_t keep_files = 5;
+        std::chrono::milliseconds sync_interval{1000};
+        // Сколько сегментов держать наготове
+        size_t standby_segments = 2;
+    };
+
+private:
+    struct Segment {
+        int fd = -1;
+        char* base = nullptr;
+        size_t size = 0;
+        std::string path;
+        std::chrono::steady_clock::time_point opened;
+
+        // Позиция следующей записи; может уйти за size, когда сегмент полон
+        std::atomic<size_t> head{0};
+        // Длина данных в закрытом сегменте
+        size_t valid = 0;
+        Segment* next_retired = nullptr;
+    };
+
+    Options opts;
+    uint64_t next_seq = 1;
+
+    std::atomic<Segment*> current{nullptr};
+    std::atomic<Segment*> retired{nullptr};
+
+    // Заготовленные сегменты по порядку номеров. Кладёт только фоновый
+    // поток; забирает тот, кто закрывает текущий сегмент, - такие вызовы
+    // не пересекаются, так как следующий seal() возможен только после
+    // подмены current.
+    collect::SpscRing<Segment*> standby;
+    std::atomic<size_t> standby_count{0};
+
+    std::deque<std::string> closed_files;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stop = false;
+    std::thread worker;
+
+    Segment* open_segment() {
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), ".%06llu.log",
+                      static_cast<unsigned long long>(this->next_seq++));
+
+        auto seg = new Segment();
+        seg->path = this->opts.prefix + suffix;
+        seg->size = this->opts.segment_size;
+
+        seg->fd = ::open(seg->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (seg->fd < 0) {
+            std::cerr << "Cannot open log file: " << seg->path << std::endl;
+            delete seg;
+            return nullptr;
+        }
+
+        if (::fallocate(seg->fd, 0, 0, seg->size) != 0 && ::ftruncate(seg->fd, seg->size) != 0) {
+            std::cerr << "Cannot allocate log file: " << seg->path << std::endl;
+            ::close(seg->fd);
+            ::unlink(seg->path.c_str());
+            delete seg;
+            return nullptr;
+        }
+
+        void* p = ::mmap(nullptr, seg->size, PROT_READ | PROT_WRITE, MAP_SHARED, seg->fd, 0);
+        if (p == MAP_FAILED) {
+            std::cerr << "Cannot map log file: " << seg->path << std::endl;
+            ::close(seg->fd);
+            ::unlink(seg->path.c_str());
+            delete seg;
+            return nullptr;
+        }
+
+        seg->base = static_cast<char*>(p);
+        seg->opened = std::chrono::steady_clock::now();
+        return seg;
+    }
+
+    // Сбросить сегмент на диск, обрезать до реальной длины и закрыть
+    static void close_segment(Segment* seg, bool keep) {
+        ::msync(seg->base, seg->size, MS_SYNC);
+        ::munmap(seg->base, seg->size);
+        if (keep) {
+            if (::ftruncate(seg->fd, seg->valid) != 0) {
+                std::cerr << "Cannot truncate log file: " << seg->path << std::endl;
+            }
+        } else {
+            ::unlink(seg->path.c_str());
+        }
+        ::close(seg->fd);
+    }
+
+    // Вызывается ровно одним потоком - тем, чья позиция первой вышла за
+    // конец сегмента. off - длина данных в сегменте.
+    void seal(Segment* seg, size_t off) {
+        seg->valid = off;
+
+        Segment* next = nullptr;
+        if (this->standby.pop(next)) {
+            this->standby_count.fetch_sub(1, std::memory_order_relaxed);
+        }
+        // Без заготовки пишущие потоки теряют записи, пока фоновый поток
+        // не поставит новый сегмент
+        this->current.store(next, std::memory_order_seq_cst);
+
+        Segment* head = this->retired.load(std::memory_order_relaxed);
+        do {
+            seg->next_retired = head;
+        } while (!this->retired.compare_exchange_weak(head, seg, std::memory_order_release,
+                                                      std::memory_order_relaxed));
+
+        // Пустая критическая секция: фоновый поток проверяет условие под mtx,
+        // поэтому пробуждение не теряется. Сам mtx он держит только на проверке.
+        { std::lock_guard<std::mutex> lock(this->mtx); }
+        this->cv.notify_one();
+    }
+
+    // Нужен ли фоновому потоку новый сегмент
+    bool needs_segment() const {
+        return !this->current.load(std::memory_order_acquire)
+            || this->standby_count.load(std::memory_order_relaxed) < this->opts.standby_segments;
+    }
+
+    // Закрыть сегменты, из которых уже никто не пишет. Только фоновый поток.
+    void collect(bool final) {
+        Segment* list = this->retired.exchange(nullptr, std::memory_order_acquire);
+        Segment* busy = nullptr;
+
+        while (list) {
+            Segment* seg = list;
+            list = seg->next_retired;
+
+            if (!final && rcu::is_protected(seg)) {
+                seg->next_retired = busy;
+                busy = seg;
+                continue;
+            }
+
+            close_segment(seg, true);
+            this->closed_files.push_back(seg->path);
+            delete seg;
+        }
+
+        while (busy) {
+            Segment* seg = busy;
+            busy = seg->next_retired;
+            Segment* head = this->retired.load(std::memory_order_relaxed);
+            do {
+                seg->next_retired = head;
+            } while (!this->retired.compare_exchange_weak(head, seg, std::memory_order_release,
+                                                          std::memory_order_relaxed));
+        }
+
+        while (this->closed_files.size() > this->opts.keep_files) {
+            ::unlink(this->closed_files.front().c_str());
+            this->closed_files.pop_front();
+        }
+    }
+
+    void run() {
+        auto last_sync = std::chrono::steady_clock::now();
+
+        for (;;) {
+            // Сегменты открываем без mtx: seal() не должен их ждать
+            bool failed = false;
+            if (!this->current.load()) {
+                Segment* seg = nullptr;
+                if (this->standby.pop(seg)) {
+                    this->standby_count.fetch_sub(1, std::memory_order_relaxed);
+                } else {
+                    seg = open_segment();
+                }
+                failed = !seg;
+                this->current.store(seg);
+            }
+            while (!failed && this->standby_count.load(std::memory_order_relaxed) < this->opts.standby_segments) {
+                Segment* seg = open_segment();
+                if (!seg) {
+                    failed = true;
+                    break;
+                }
+                this->standby.push(std::move(seg));
+                this->standby_count.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            {
+                rcu::Guard<Segment> seg(this->current);
+                if (seg.get()) {
+                    if (this->opts.rotate_interval.count() > 0
+                        && now - seg->opened >= this->opts.rotate_interval
+                        && seg->head.load(std::memory_order_relaxed) > 0) {
+                        // Ротация по времени: занимаем весь остаток сегмента
+                        size_t off = seg->head.fetch_add(seg->size + 1);
+                        if (off <= seg->size) seal(seg.get(), off);
+                    } else if (now - last_sync >= this->opts.sync_interval) {
+                        ::msync(seg->base, seg->size, MS_ASYNC);
+                        last_sync = now;
+                    }
+                }
+            }
+            collect(false);
+
+            // Если открыть сегмент не удалось, повторяем не раньше таймаута
+            std::unique_lock<std::mutex> lock(this->mtx);
+            this->cv.wait_for(lock, std::chrono::milliseconds(100),
+                              [&] { return this->stop || (!failed && needs_segment()); });
+            if (this->stop) return;
+        }
+    }
+
+public:
+    MmapFileLogger() : MmapFileLogger(Options()) {}
+
+    explicit MmapFileLogger(Options options)
+        : opts(std::move(options)), standby(std::max<size_t>(this->opts.standby_segments, 1)) {
+        this->opts.segment_size = std::max<size_t>(this->opts.segment_size, 4096);
+        this->opts.standby_segments = std::max<size_t>(this->opts.standby_segments, 1);
+        this->current.store(open_segment());
+        this->worker = std::thread(&MmapFileLogger::run, this);
+    }
+
+    // Писатели к этому моменту должны завершиться
+    ~MmapFileLogger() {
+        {
+            std::lock_guard<std::mutex> lock(this->mtx);
+            this->stop = true;
+        }
+        this->cv.notify_one();
+        this->worker.join();
+
+        if (Segment* seg = this->current.exchange(nullptr)) {
+            seg->valid = std::min(seg->head.load(), seg->size);
+            close_segment(seg, true);
+            delete seg;
+        }
+        collect(true);
+
+        Segment* seg = nullptr;
+        while (this->standby.pop(seg)) {
+            close_segment(seg, false);
+            delete seg;
+        }
+    }
+
+    std::string name() const override { return "mmap"; }
+
+    void log(LogLevel level, const std::string& message) override {
+        char line[128];
+        size_t prefix = local_timestamp(line);
+        prefix += std::snprintf(line + prefix, sizeof(line) - prefix, " [%s] ", to_string(level));
+
+        size_t body = std::min(message.size(), this->opts.segment_size - prefix - 1);
+        size_t len = prefix + body + 1;
+
+        for (;;) {
+            rcu::Guard<Segment> seg(this->current);
+            if (!seg.get()) {
+                this->sink_metrics.dropped.add();
+                return;
+            }
+
+            size_t off = seg->head.fetch_add(len, std::memory_order_relaxed);
+            if (off + len <= seg->size) {
+                char* dst = seg->base + off;
+                std::memcpy(dst, line, prefix);
+                std::memcpy(dst + prefix, message.data(), body);
+                dst[prefix + body] = '\n';
+                this->sink_metrics.bytes.add(len);
+                return;
+            }
+
+            if (off <= seg->size) {
+                seal(seg.get(), off);
+            } else {
+                // Сегмент уже закрывает другой поток; ждём подмены
+                std::this_thread::yield();
+            }
+        }
+    }
+};
+
+#endif // __linux__
+
+#endif // MMAP_LOGGER_H
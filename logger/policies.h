@@ -0,0 +1,207 @@
+#ifndef POLICIES_H
+#define POLICIES_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Защита от "шторма" логов: политики, которые GLogger применяет до синков.
+//
+//  - ограничение частоты (token bucket) на уровень и на место вызова;
+//  - вероятностная выборка для DEBUG/INFO;
+//  - схлопывание одинаковых подряд сообщений одного места вызова в
+//    "last message repeated N times".
+//
+// Все проверки - атомарные операции без блокировок. Уровень передаётся
+// индексом (static_cast<size_t>(LogLevel)).
+
+namespace policy {
+
+constexpr size_t LEVELS = 5;
+
+inline int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Token bucket в форме GCRA: состояние - одно число, "теоретическое время
+// прихода" следующего сообщения. Пропускаем, если оно не дальше чем
+// tolerance от текущего момента.
+class RateLimiter {
+    std::atomic<int64_t> tat{0};
+
+public:
+    // interval - нс на один токен (0 - без ограничения), tolerance - запас на burst
+    bool allow(int64_t now, int64_t interval, int64_t tolerance) {
+        if (interval <= 0) return true;
+
+        int64_t t = this->tat.load(std::memory_order_relaxed);
+        for (;;) {
+            int64_t base = t > now ? t : now;
+            if (base - now > tolerance) return false;
+            if (this->tat.compare_exchange_weak(t, base + interval, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+};
+
+// Параметры лимита: per_second сообщений в секунду, всплеск до burst
+class RateLimit {
+    std::atomic<int64_t> interval{0};
+    std::atomic<int64_t> tolerance{0};
+
+public:
+    void set(double per_second, unsigned burst) {
+        if (per_second <= 0) {
+            this->interval.store(0, std::memory_order_relaxed);
+            return;
+        }
+        int64_t step = static_cast<int64_t>(1e9 / per_second);
+        if (step < 1) step = 1;
+        this->tolerance.store(step * (burst > 0 ? burst - 1 : 0), std::memory_order_relaxed);
+        this->interval.store(step, std::memory_order_relaxed);
+    }
+
+    bool allow(RateLimiter& limiter, int64_t now) const {
+        return limiter.allow(now, this->interval.load(std::memory_order_relaxed),
+                             this->tolerance.load(std::memory_order_relaxed));
+    }
+};
+
+// Последнее сообщение и число его повторов. Сравниваются хеши (уровень +
+// текст); при гонке счётчик может немного ошибиться, зато без блокировок.
+class RepeatState {
+    std::atomic<uint64_t> last_hash{0};
+    std::atomic<uint64_t> repeats{0};
+    std::atomic<size_t> last_level{0};
+
+public:
+    // true - сообщение повторяет предыдущее и должно быть подавлено.
+    // Иначе в pending - сколько повторов предыдущего накопилось (и его уровень).
+    bool check(size_t level, const std::string& message, uint64_t& pending, size_t& pending_level) {
+        uint64_t h = std::hash<std::string>()(message) * 31 + level + 1;
+        if (this->last_hash.load(std::memory_order_relaxed) == h) {
+            this->repeats.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        uint64_t prev = this->last_hash.exchange(h, std::memory_order_acq_rel);
+        if (prev == h) {
+            this->repeats.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        pending_level = this->last_level.exchange(level, std::memory_order_relaxed);
+        pending = this->repeats.exchange(0, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Забрать накопленные повторы, не дожидаясь следующего сообщения
+    uint64_t flush(size_t& level) {
+        this->last_hash.store(0, std::memory_order_relaxed);
+        level = this->last_level.load(std::memory_order_relaxed);
+        return this->repeats.exchange(0, std::memory_order_relaxed);
+    }
+};
+
+struct CallSite;
+
+// Все места вызова GLOG_*: список только растёт, места живут до конца программы
+inline std::atomic<CallSite*> call_sites{nullptr};
+
+// Место вызова; заводится статической переменной макросом GLOG_*.
+// Лимит и схлопывание повторов у каждого места свои, так что потоки,
+// пишущие из разных мест, не делят кеш-линии.
+struct CallSite {
+    const char* file;
+    int line;
+    RateLimiter limiter;
+    // Сколько сообщений отброшено с последнего пропущенного
+    std::atomic<uint64_t> suppressed{0};
+    RepeatState repeats;
+    CallSite* next = nullptr;
+
+    CallSite(const char* file, int line) : file(file), line(line) {
+        CallSite* head = call_sites.load(std::memory_order_relaxed);
+        do {
+            this->next = head;
+        } while (!call_sites.compare_exchange_weak(head, this, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+    }
+};
+
+template <typename Fn>
+inline void for_each_call_site(Fn fn) {
+    for (CallSite* s = call_sites.load(std::memory_order_acquire); s; s = s->next) fn(*s);
+}
+
+// Выборка: доля пропускаемых сообщений в виде порога для 32-битного случайного числа
+class Sampler {
+    std::atomic<uint64_t> threshold[LEVELS];
+
+    static uint32_t next_random() {
+        thread_local uint64_t state =
+            (std::hash<std::thread::id>()(std::this_thread::get_id()) ^ static_cast<uint64_t>(now_ns())) | 1;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<uint32_t>(state >> 32);
+    }
+
+public:
+    static constexpr uint64_t ALL = uint64_t(1) << 32;
+
+    Sampler() {
+        for (auto& t : this->threshold) t.store(ALL, std::memory_order_relaxed);
+    }
+
+    void set(size_t level, double rate) {
+        if (rate < 0) rate = 0;
+        if (rate > 1) rate = 1;
+        this->threshold[level].store(static_cast<uint64_t>(rate * ALL), std::memory_order_relaxed);
+    }
+
+    bool allow(size_t level) const {
+        uint64_t t = this->threshold[level].load(std::memory_order_relaxed);
+        return t >= ALL || next_random() < t;
+    }
+};
+
+// Схлопывание повторов в потоке сообщений одного места вызова
+class RepeatCollapser {
+    std::atomic<bool> enabled{false};
+    RepeatState global;
+
+public:
+    void enable(bool on) { this->enabled.store(on, std::memory_order_relaxed); }
+
+    // site - состояние места вызова GLOG_*; без него - общее для всех
+    // вызовов GLogger::log напрямую
+    bool check(size_t level, const std::string& message, RepeatState* site,
+               uint64_t& pending, size_t& pending_level) {
+        pending = 0;
+        if (!this->enabled.load(std::memory_order_relaxed)) return false;
+        return (site ? *site : this->global).check(level, message, pending, pending_level);
+    }
+
+    uint64_t flush(size_t& level) { return this->global.flush(level); }
+};
+
+// Все политики GLogger вместе
+struct StormPolicy {
+    RateLimit level_limits[LEVELS];
+    RateLimiter level_limiters[LEVELS];
+    std::atomic<uint64_t> level_suppressed[LEVELS] = {};
+
+    RateLimit call_site_limit;
+    Sampler sampler;
+    RepeatCollapser repeats;
+};
+
+} // namespace policy
+
+#endif // POLICIES_H
@@ -0,0 +1,221 @@
+#ifndef RCU_H
+#define RCU_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Указатель на неизменяемый снимок данных (RCU / copy-on-write).
+//
+// Читатель: одна атомарная загрузка + публикация указателя в своём
+// hazard-слоте, без блокировок. Hazard-слоты у каждого потока свои и лежат
+// на отдельных кеш-линиях, так что читатели друг другу не мешают.
+//
+// Писатель: копирует снимок, меняет копию и атомарно подменяет указатель,
+// затем ждёт, пока старый снимок отпустят читатели других потоков, и удаляет
+// его. Исключение - снимок, который держит сам пишущий поток: он удаляется
+// при одной из следующих записей. Писатели сериализуются мьютексом.
+//
+// Писателю нельзя держать блокировку, которую читатель может взять, держа
+// снимок: запись ждёт читателя.
+
+namespace rcu {
+
+// Сколько снимков один поток может держать одновременно (вложенные чтения)
+constexpr int MAX_NESTING = 8;
+
+struct alignas(64) HazardRecord {
+    std::atomic<const void*> ptrs[MAX_NESTING] = {};
+    std::atomic<bool> used{false};
+    HazardRecord* next = nullptr;
+};
+
+// Список записей только растёт; записи переиспользуются после выхода потока
+// и живут до конца программы.
+inline std::atomic<HazardRecord*> hazard_head{nullptr};
+
+inline HazardRecord* acquire_record() {
+    for (HazardRecord* r = hazard_head.load(std::memory_order_acquire); r; r = r->next) {
+        bool expected = false;
+        if (!r->used.load(std::memory_order_relaxed)
+            && r->used.compare_exchange_strong(expected, true)) {
+            return r;
+        }
+    }
+
+    HazardRecord* r = new HazardRecord();
+    r->used.store(true, std::memory_order_relaxed);
+    HazardRecord* head = hazard_head.load(std::memory_order_relaxed);
+    do {
+        r->next = head;
+    } while (!hazard_head.compare_exchange_weak(head, r, std::memory_order_release,
+                                                std::memory_order_relaxed));
+    return r;
+}
+
+inline bool is_protected(const void* p) {
+    for (HazardRecord* r = hazard_head.load(std::memory_order_acquire); r; r = r->next) {
+        for (const auto& slot : r->ptrs) {
+            if (slot.load(std::memory_order_seq_cst) == p) return true;
+        }
+    }
+    return false;
+}
+
+// Hazard-запись текущего потока
+struct ThreadHazards {
+    HazardRecord* record = acquire_record();
+    int depth = 0;
+
+    ~ThreadHazards() {
+        for (auto& slot : this->record->ptrs) slot.store(nullptr, std::memory_order_relaxed);
+        this->record->used.store(false, std::memory_order_release);
+    }
+};
+
+inline ThreadHazards& thread_hazards() {
+    thread_local ThreadHazards hazards;
+    return hazards;
+}
+
+// Держит ли p какой-нибудь поток, кроме текущего
+inline bool is_protected_by_others(const void* p) {
+    const HazardRecord* own = thread_hazards().record;
+    for (HazardRecord* r = hazard_head.load(std::memory_order_acquire); r; r = r->next) {
+        if (r == own) continue;
+        for (const auto& slot : r->ptrs) {
+            if (slot.load(std::memory_order_seq_cst) == p) return true;
+        }
+    }
+    return false;
+}
+
+// Защищённое чтение указателя из src; пока guard жив, объект не будет
+// удалён писателем, проверяющим is_protected().
+template <typename T>
+class Guard {
+    std::atomic<const void*>* slot;
+    T* ptr;
+
+public:
+    explicit Guard(const std::atomic<T*>& src) {
+        ThreadHazards& h = thread_hazards();
+        if (h.depth >= MAX_NESTING) throw std::runtime_error("rcu: read nesting too deep");
+        this->slot = &h.record->ptrs[h.depth++];
+
+        T* p = src.load(std::memory_order_acquire);
+        for (;;) {
+            this->slot->store(p, std::memory_order_seq_cst);
+            T* again = src.load(std::memory_order_seq_cst);
+            if (again == p) break;
+            p = again;
+        }
+        this->ptr = p;
+    }
+
+    ~Guard() {
+        this->slot->store(nullptr, std::memory_order_release);
+        --thread_hazards().depth;
+    }
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+    T* get() const        { return this->ptr; }
+    T& operator*() const  { return *this->ptr; }
+    T* operator->() const { return this->ptr; }
+};
+
+template <typename T>
+class RcuPtr {
+    std::atomic<const T*> current;
+    std::mutex write_mtx;
+    std::vector<const T*> retired;
+
+    // Удалить снимки, которые больше никто не читает. Под write_mtx.
+    void reclaim() {
+        auto it = this->retired.begin();
+        while (it != this->retired.end()) {
+            if (!is_protected(*it)) {
+                delete *it;
+                it = this->retired.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Подменить снимок; возвращает старый. Под write_mtx.
+    const T* publish(const T* next) {
+        const T* old = this->current.exchange(next, std::memory_order_seq_cst);
+        if (old) this->retired.push_back(old);
+        return old;
+    }
+
+    // Дождаться, пока old отпустят другие потоки, и удалить всё, что можно.
+    // Ждём без write_mtx: читатель, держащий old, может сам писать сюда.
+    void retire(const T* old) {
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(this->write_mtx);
+                // old уже могла удалить другая запись, а адрес - занять новый снимок
+                const bool waiting = std::find(this->retired.begin(), this->retired.end(), old)
+                    != this->retired.end();
+                if (!waiting || !is_protected_by_others(old)) {
+                    reclaim();
+                    return;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    using ReadGuard = Guard<const T>;
+
+    RcuPtr() : current(new T()) {}
+    explicit RcuPtr(std::unique_ptr<T> init) : current(init.release()) {}
+
+    // Деструктор вызывается, когда читателей уже нет
+    ~RcuPtr() {
+        delete this->current.load();
+        for (const T* p : this->retired) delete p;
+    }
+
+    RcuPtr(const RcuPtr&) = delete;
+    RcuPtr& operator=(const RcuPtr&) = delete;
+
+    ReadGuard read() const { return ReadGuard(this->current); }
+
+    // Возвращается, когда старый снимок удалён (если его не держит сам
+    // вызывающий поток)
+    void store(std::unique_ptr<T> next) {
+        const T* old = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(this->write_mtx);
+            old = publish(next.release());
+        }
+        if (old) retire(old);
+    }
+
+    // Copy-on-write: fn получает копию текущего снимка и меняет её
+    template <typename Fn>
+    void update(Fn fn) {
+        const T* old = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(this->write_mtx);
+            auto next = std::make_unique<T>(*this->current.load(std::memory_order_acquire));
+            fn(*next);
+            old = publish(next.release());
+        }
+        if (old) retire(old);
+    }
+};
+
+} // namespace rcu
+
+#endif // RCU_H
@@ -0,0 +1,271 @@
+#ifndef SYSLOG_LOGGER_H
+#define SYSLOG_LOGGER_H
+
+#include "iface.h"
+#include "rcu.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <unistd.h>
+
+// Syslog без libc: датаграммы RFC 3164 / RFC 5424 напрямую в /dev/log
+// (или другой unix-сокет, например тестовый).
+//
+// Заголовок собирается из заранее подготовленных частей; метка времени
+// форматируется раз в секунду на поток. log_batch() отправляет пачку
+// одним sendmmsg - это работает в паре с AsyncLogger.
+//
+// Сокет неблокирующий: если очередь приёмника переполнена или демона нет,
+// сообщения отбрасываются и учитываются в dropped(), вызывающий поток не ждёт.
+//
+// Отправители держат сокет под rcu::Guard. Отключённый сокет закрывается,
+// только когда его не держит ни один из них, - иначе номер дескриптора мог
+// бы достаться новому сокету или чужому файлу до их sendmmsg.
+class UnixSyslogLogger : public ILogger {
+public:
+    enum class Format {
+        RFC3164,
+        RFC5424
+    };
+
+    struct Options {
+        std::string path = "/dev/log";
+        std::string ident = "CppLoggerApp";
+        int facility = LOG_USER;
+        Format format = Format::RFC3164;
+    };
+
+private:
+    // Больше за один sendmmsg не отправляем
+    static constexpr size_t BATCH = 64;
+    // Не чаще раза в секунду пытаемся переподключиться
+    static constexpr int64_t RECONNECT_NS = 1000000000;
+
+    Options opts;
+    // Постоянная часть заголовка после метки времени
+    std::string tail;
+
+    struct Socket {
+        int fd;
+        explicit Socket(int fd) : fd(fd) {}
+        ~Socket() { ::close(this->fd); }
+    };
+
+    std::atomic<Socket*> sock{nullptr};
+    std::mutex connect_mtx;
+    std::atomic<int64_t> last_connect{0};
+    // Отключённые сокеты, которые ещё может держать отправитель. Под connect_mtx.
+    std::vector<Socket*> retired;
+
+    static int priority_of(LogLevel level) {
+        switch (level) {
+            case LogLevel::DEBUG:    return LOG_DEBUG;
+            case LogLevel::INFO:     return LOG_INFO;
+            case LogLevel::WARNING:  return LOG_WARNING;
+            case LogLevel::ERROR:    return LOG_ERR;
+            case LogLevel::CRITICAL: return LOG_CRIT;
+        }
+        return LOG_INFO;
+    }
+
+    static int64_t to_ns(std::chrono::system_clock::time_point t) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+    }
+
+    // Закрыть отключённые сокеты, которые больше никто не держит. Под connect_mtx.
+    void reclaim() {
+        auto it = this->retired.begin();
+        while (it != this->retired.end()) {
+            if (!rcu::is_protected(*it)) {
+                delete *it;
+                it = this->retired.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void retire(Socket* s) {
+        std::lock_guard<std::mutex> lock(this->connect_mtx);
+        this->retired.push_back(s);
+        reclaim();
+    }
+
+    void connect_socket() {
+        std::unique_lock<std::mutex> lock(this->connect_mtx, std::try_to_lock);
+        if (!lock.owns_lock()) return;
+        reclaim();
+
+        int64_t now = to_ns(std::chrono::system_clock::now());
+        int64_t last = this->last_connect.load(std::memory_order_relaxed);
+        if (last != 0 && now - last < RECONNECT_NS) return;
+        this->last_connect.store(now, std::memory_order_relaxed);
+
+        int s = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (s < 0) return;
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, this->opts.path.c_str(), sizeof(addr.sun_path) - 1);
+
+        if (::connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(s);
+            return;
+        }
+
+        Socket* old = this->sock.exchange(new Socket(s));
+        if (old) {
+            this->retired.push_back(old);
+            reclaim();
+        }
+    }
+
+    // Ошибки, после которых имеет смысл переподключиться
+    static bool is_disconnect(int err) {
+        return err == ECONNREFUSED || err == ENOTCONN || err == ENOENT || err == EBADF;
+    }
+
+    // Заголовок до сообщения. Метка времени кешируется на секунду.
+    void header(std::string& buf, LogLevel level, std::chrono::system_clock::time_point time) const {
+        thread_local int64_t cached_sec = -1;
+        thread_local Format cached_format = Format::RFC3164;
+        thread_local char stamp[64];
+        thread_local size_t stamp_len = 0;
+
+        int64_t ns = to_ns(time);
+        int64_t sec = ns / 1000000000;
+        if (sec != cached_sec || cached_format != this->opts.format) {
+            std::time_t t = static_cast<std::time_t>(sec);
+            std::tm tm_now;
+            if (this->opts.format == Format::RFC3164) {
+                localtime_r(&t, &tm_now);
+                stamp_len = std::strftime(stamp, sizeof(stamp), "%b %e %H:%M:%S", &tm_now);
+            } else {
+                gmtime_r(&t, &tm_now);
+                stamp_len = std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &tm_now);
+            }
+            cached_sec = sec;
+            cached_format = this->opts.format;
+        }
+
+        char pri[16];
+        int pri_len = std::snprintf(pri, sizeof(pri), "<%d>", this->opts.facility | priority_of(level));
+
+        buf.assign(pri, pri_len);
+        if (this->opts.format == Format::RFC5424) {
+            char frac[16];
+            int frac_len = std::snprintf(frac, sizeof(frac), ".%06dZ ", static_cast<int>(ns / 1000 % 1000000));
+            buf += "1 ";
+            buf.append(stamp, stamp_len);
+            buf.append(frac, frac_len);
+        } else {
+            buf.append(stamp, stamp_len);
+            buf += ' ';
+        }
+        buf += this->tail;
+    }
+
+public:
+    UnixSyslogLogger() : UnixSyslogLogger(Options()) {}
+
+    explicit UnixSyslogLogger(Options options) : opts(std::move(options)) {
+        std::string pid = std::to_string(::getpid());
+        if (this->opts.format == Format::RFC5424) {
+            char host[256] = "-";
+            if (::gethostname(host, sizeof(host)) != 0) std::strcpy(host, "-");
+            host[sizeof(host) - 1] = '\0';
+            this->tail = std::string(host) + " " + this->opts.ident + " " + pid + " - - ";
+        } else {
+            this->tail = this->opts.ident + "[" + pid + "]: ";
+        }
+        connect_socket();
+    }
+
+    // Отправителей к этому моменту уже нет
+    ~UnixSyslogLogger() {
+        delete this->sock.exchange(nullptr);
+        for (Socket* s : this->retired) delete s;
+    }
+
+    std::string name() const override { return "unix-syslog"; }
+
+    void log(LogLevel level, const std::string& message) override {
+        LogRecord record{level, std::chrono::system_clock::now(), message};
+        log_batch(&record, 1);
+    }
+
+    void log_batch(const LogRecord* records, size_t count) override {
+        thread_local std::vector<std::string> headers(BATCH);
+        mmsghdr msgs[BATCH];
+        iovec iov[BATCH][2];
+
+        size_t done = 0;
+        while (done < count) {
+            if (!this->sock.load(std::memory_order_acquire)) connect_socket();
+            rcu::Guard<Socket> s(this->sock);
+            if (!s.get()) {
+                this->sink_metrics.dropped.add(count - done);
+                return;
+            }
+
+            size_t n = std::min(BATCH, count - done);
+            for (size_t i = 0; i < n; ++i) {
+                const LogRecord& r = records[done + i];
+                header(headers[i], r.level, r.time);
+
+                iov[i][0].iov_base = const_cast<char*>(headers[i].data());
+                iov[i][0].iov_len = headers[i].size();
+                iov[i][1].iov_base = const_cast<char*>(r.message.data());
+                iov[i][1].iov_len = r.message.size();
+
+                std::memset(&msgs[i], 0, sizeof(msgs[i]));
+                msgs[i].msg_hdr.msg_iov = iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 2;
+            }
+
+            int sent = ::sendmmsg(s->fd, msgs, static_cast<unsigned>(n), MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (sent < 0) {
+                int err = errno;
+                if (err == EINTR) continue;
+                if (err == EMSGSIZE) {
+                    // Слишком длинная датаграмма: теряем только её
+                    this->sink_metrics.dropped.add();
+                    ++done;
+                    continue;
+                }
+                if (is_disconnect(err)) {
+                    // Закроется, когда его отпустят все отправители (и этот)
+                    Socket* expected = s.get();
+                    if (this->sock.compare_exchange_strong(expected, nullptr)) retire(s.get());
+                }
+                // EAGAIN и прочее: приёмник не успевает, остаток пачки отбрасываем
+                this->sink_metrics.dropped.add(count - done);
+                return;
+            }
+            for (int i = 0; i < sent; ++i) {
+                this->sink_metrics.bytes.add(iov[i][0].iov_len + iov[i][1].iov_len);
+            }
+            done += static_cast<size_t>(sent);
+        }
+    }
+
+    size_t dropped() const { return this->sink_metrics.dropped.get(); }
+};
+
+#endif // __linux__
+
+#endif // SYSLOG_LOGGER_H
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "../binlog.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+static std::string temp_path(const char* name) {
+    return "/tmp/test_binlog_" + std::to_string(::getpid()) + "_" + name;
+}
+
+// Число записей 'R' в файле бинарного лога
+static size_t count_records(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t pos = sizeof(binlog::MAGIC) + sizeof(binlog::VERSION);
+    size_t records = 0;
+    while (pos < data.size()) {
+        uint8_t tag = static_cast<uint8_t>(data[pos]);
+        uint16_t len = 0;
+        if (tag == binlog::TAG_FORMAT) {
+            std::memcpy(&len, data.data() + pos + 1 + 4, sizeof(len));
+            pos += 1 + 4 + 2 + len;
+        } else if (tag == binlog::TAG_RECORD) {
+            std::memcpy(&len, data.data() + pos + 1 + 4 + 1 + 8, sizeof(len));
+            pos += 1 + 4 + 1 + 8 + 2 + len;
+            ++records;
+        } else {
+            ADD_FAILURE() << "unknown tag " << int(tag) << " at " << pos;
+            break;
+        }
+    }
+    return records;
+}
+
+// Поток, который пишет только через BINLOG: его буфер создаётся раньше
+// hazard-записи rcu и сбрасывается в деструкторе при выходе потока
+TEST(Binlog, ThreadThatOnlyUsesBinlogFlushesOnExit) {
+    const std::string path = temp_path("exit.blog");
+    auto sink = std::make_shared<binlog::BinaryFileLogger>(path);
+
+    const int threads = 32;
+    const int per_thread = 10;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([t] {
+            for (int i = 0; i < per_thread; ++i) BINLOG(LogLevel::INFO, "thread {} step {}", t, i);
+        });
+    }
+    // Читатели rcu в это же время занимают освободившиеся hazard-записи
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([] {
+            for (int i = 0; i < 1000; ++i) GLogger::stats();
+        });
+    }
+    for (auto& w : workers) w.join();
+    for (auto& r : readers) r.join();
+
+    EXPECT_FALSE(rcu::is_protected(sink.get()));
+    sink.reset();
+
+    EXPECT_EQ(count_records(path), size_t(threads * per_thread));
+    std::remove(path.c_str());
+}
+
+TEST(Binlog, FormatWithoutArguments) {
+    const std::string path = temp_path("noargs.blog");
+    {
+        binlog::BinaryFileLogger sink(path);
+        BINLOG(LogLevel::WARNING, "no arguments here");
+        binlog::flush();
+    }
+    EXPECT_EQ(count_records(path), 1u);
+    std::remove(path.c_str());
+}
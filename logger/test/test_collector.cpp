@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "../iface.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Считает записи и проверяет, что они пришли по возрастанию времени
+class CountingLogger : public ILogger {
+public:
+    std::atomic<size_t> count{0};
+    bool ordered = true;
+    std::chrono::system_clock::time_point last{};
+
+    void log(LogLevel, const std::string&) override { ++this->count; }
+
+    void log_batch(const LogRecord* records, size_t n) override {
+        for (size_t i = 0; i < n; ++i) {
+            if (records[i].time < this->last) this->ordered = false;
+            this->last = records[i].time;
+        }
+        this->count += n;
+    }
+};
+
+TEST(Collector, ShortLivedThreadsLoseNothing) {
+    auto sink = std::make_shared<CountingLogger>();
+    GLogger::add(sink);
+    GLogger::start_collector();
+
+    // Потоки живут недолго и завершаются вперемешку с раундами сборщика
+    const int threads = 2000;
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back([i] {
+            for (int k = 0; k < 3; ++k) GLogger::info("thread " + std::to_string(i));
+        });
+    }
+    for (auto& t : workers) t.join();
+
+    GLogger::stop_collector();
+    GLogger::clear();
+
+    EXPECT_EQ(sink->count.load(), size_t(threads * 3));
+    EXPECT_TRUE(sink->ordered);
+}
+
+TEST(Collector, MergesThreadsInTimeOrder) {
+    auto sink = std::make_shared<CountingLogger>();
+    GLogger::add(sink);
+    collect::Options options;
+    options.capacity = 64;  // маленькое кольцо: производители ждут сборщик
+    GLogger::start_collector(options);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([] {
+            for (int k = 0; k < 5000; ++k) GLogger::info("message");
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    GLogger::stop_collector();
+    auto stats = GLogger::stats();
+    GLogger::clear();
+
+    EXPECT_EQ(sink->count.load(), size_t(8 * 5000));
+    EXPECT_TRUE(sink->ordered);
+
+    // Задержка пачки записана на каждое сообщение
+    EXPECT_EQ(sink->metrics().latency.count(), uint64_t(8 * 5000));
+
+    auto it = std::find_if(stats.sinks.begin(), stats.sinks.end(),
+                           [](const metrics::SinkStats& k) { return k.name == "collector"; });
+    ASSERT_NE(it, stats.sinks.end());
+    EXPECT_GE(it->messages, uint64_t(8 * 5000));
+    EXPECT_GT(it->queue_high_water, 0u);
+    EXPECT_EQ(it->queue_depth, 0u);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include "../mmap_logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+// Временный каталог под сегменты
+class MmapDir {
+public:
+    std::string path;
+
+    MmapDir() {
+        this->path = "/tmp/test_mmap_" + std::to_string(::getpid());
+        std::system(("rm -rf " + this->path + " && mkdir -p " + this->path).c_str());
+    }
+
+    ~MmapDir() { std::system(("rm -rf " + this->path).c_str()); }
+
+    std::vector<std::string> files() const {
+        std::vector<std::string> out;
+        if (DIR* d = ::opendir(this->path.c_str())) {
+            while (dirent* e = ::readdir(d)) {
+                std::string name = e->d_name;
+                if (name != "." && name != "..") out.push_back(this->path + "/" + name);
+            }
+            ::closedir(d);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+};
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+// Сегменты сменяются по размеру, старые файлы удаляются сверх keep_files,
+// закрытые файлы обрезаны до данных и состоят из целых строк
+TEST(MmapFileLogger, RotatesBySizeAndKeepsFiles) {
+    MmapDir dir;
+    MmapFileLogger::Options opts;
+    opts.prefix = dir.path + "/app";
+    opts.segment_size = 4096;
+    opts.keep_files = 3;
+
+    const int segments = 12;
+    const int per_segment = 100;  // строк примерно на один сегмент
+    uint64_t dropped = 0;
+    {
+        MmapFileLogger logger(opts);
+        for (int s = 0; s < segments; ++s) {
+            for (int i = 0; i < per_segment; ++i) {
+                logger.log(LogLevel::INFO, "line " + std::to_string(s * per_segment + i));
+            }
+            // Фоновому потоку хватает времени, если его будят при каждой смене сегмента
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        dropped = logger.metrics().dropped.get();
+    }
+    EXPECT_EQ(dropped, 0u);
+
+    auto files = dir.files();
+    EXPECT_EQ(files.size(), opts.keep_files + 1);
+
+    std::string all;
+    for (const auto& f : files) {
+        std::string data = read_file(f);
+        EXPECT_LE(data.size(), opts.segment_size) << f;
+        ASSERT_FALSE(data.empty()) << f;
+        EXPECT_EQ(data.back(), '\n') << f;
+        EXPECT_EQ(data.find('\0'), std::string::npos) << f;
+        all += data;
+    }
+    // Последняя строка лежит в последнем файле
+    EXPECT_NE(all.find("line " + std::to_string(segments * per_segment - 1) + "\n"), std::string::npos);
+}
+
+TEST(MmapFileLogger, ConcurrentWritersProduceWholeLines) {
+    MmapDir dir;
+    MmapFileLogger::Options opts;
+    opts.prefix = dir.path + "/app";
+    opts.segment_size = 64 * 1024;
+    opts.keep_files = 1000;
+
+    uint64_t bytes = 0;
+    {
+        MmapFileLogger logger(opts);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < 5000; ++i) logger.log(LogLevel::INFO, "thread " + std::to_string(t));
+            });
+        }
+        for (auto& th : threads) th.join();
+        bytes = logger.metrics().bytes.get();
+    }
+
+    uint64_t total = 0;
+    for (const auto& f : dir.files()) {
+        std::string data = read_file(f);
+        total += data.size();
+        EXPECT_EQ(data.find('\0'), std::string::npos) << f;
+        if (!data.empty()) {
+            EXPECT_EQ(data.back(), '\n') << f;
+        }
+    }
+    // Всё, что учтено как записанное, есть в файлах
+    EXPECT_EQ(total, bytes);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "../iface.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Запоминает все сообщения
+class CaptureLogger : public ILogger {
+public:
+    std::mutex mtx;
+    std::vector<std::string> lines;
+
+    void log(LogLevel, const std::string& message) override {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        this->lines.push_back(message);
+    }
+
+    std::vector<std::string> take() {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        return std::move(this->lines);
+    }
+};
+
+TEST(Policies, RateLimiterAllowsBurstThenOnePerInterval) {
+    policy::RateLimiter limiter;
+    const int64_t interval = 100;
+    const int64_t tolerance = 2 * interval;  // всплеск из 3 сообщений
+
+    const int64_t t0 = 1000000;
+    EXPECT_TRUE(limiter.allow(t0, interval, tolerance));
+    EXPECT_TRUE(limiter.allow(t0, interval, tolerance));
+    EXPECT_TRUE(limiter.allow(t0, interval, tolerance));
+    EXPECT_FALSE(limiter.allow(t0, interval, tolerance));
+    EXPECT_FALSE(limiter.allow(t0 + interval - 1, interval, tolerance));
+
+    // Через interval освобождается ровно один токен
+    EXPECT_TRUE(limiter.allow(t0 + interval, interval, tolerance));
+    EXPECT_FALSE(limiter.allow(t0 + interval, interval, tolerance));
+
+    // После долгой паузы всплеск снова полный, но не больше
+    const int64_t t1 = t0 + 100 * interval;
+    int allowed = 0;
+    for (int i = 0; i < 10; ++i) allowed += limiter.allow(t1, interval, tolerance);
+    EXPECT_EQ(allowed, 3);
+
+    EXPECT_TRUE(limiter.allow(t1, 0, 0));  // interval 0 - без ограничения
+}
+
+TEST(Policies, RateLimitBurstMath) {
+    policy::RateLimit limit;
+    policy::RateLimiter limiter;
+
+    limit.set(10, 5);
+    const int64_t t0 = 1000000000;
+    int allowed = 0;
+    for (int i = 0; i < 100; ++i) allowed += limit.allow(limiter, t0);
+    EXPECT_EQ(allowed, 5);
+
+    // 10 в секунду: следующий токен через 100 мс
+    EXPECT_FALSE(limit.allow(limiter, t0 + 99000000));
+    EXPECT_TRUE(limit.allow(limiter, t0 + 100000000));
+
+    // burst 0 и 1 - без всплеска
+    policy::RateLimiter single;
+    limit.set(10, 0);
+    EXPECT_TRUE(limit.allow(single, t0));
+    EXPECT_FALSE(limit.allow(single, t0));
+
+    // 0 в секунду - снять лимит
+    limit.set(0, 5);
+    for (int i = 0; i < 100; ++i) EXPECT_TRUE(limit.allow(single, t0));
+}
+
+TEST(Policies, SamplerRate) {
+    policy::Sampler sampler;
+    const size_t n = 100000;
+
+    auto count = [&](size_t level) {
+        size_t allowed = 0;
+        for (size_t i = 0; i < n; ++i) allowed += sampler.allow(level);
+        return allowed;
+    };
+
+    EXPECT_EQ(count(0), n);  // по умолчанию пропускается всё
+
+    sampler.set(0, 0);
+    EXPECT_EQ(count(0), 0u);
+
+    sampler.set(0, 1);
+    EXPECT_EQ(count(0), n);
+
+    sampler.set(1, 0.25);
+    size_t allowed = count(1);
+    EXPECT_GT(allowed, n * 23 / 100);
+    EXPECT_LT(allowed, n * 27 / 100);
+
+    EXPECT_EQ(count(0), n);  // уровни независимы
+}
+
+TEST(Policies, RepeatStateCountsRepeats) {
+    policy::RepeatState state;
+    uint64_t pending = 0;
+    size_t pending_level = 0;
+
+    EXPECT_FALSE(state.check(1, "a", pending, pending_level));
+    EXPECT_EQ(pending, 0u);
+    EXPECT_TRUE(state.check(1, "a", pending, pending_level));
+    EXPECT_TRUE(state.check(1, "a", pending, pending_level));
+
+    // Тот же текст на другом уровне - другое сообщение
+    EXPECT_FALSE(state.check(3, "a", pending, pending_level));
+    EXPECT_EQ(pending, 2u);
+    EXPECT_EQ(pending_level, 1u);
+
+    EXPECT_TRUE(state.check(3, "a", pending, pending_level));
+    size_t level = 0;
+    EXPECT_EQ(state.flush(level), 1u);
+    EXPECT_EQ(level, 3u);
+
+    // После flush то же сообщение снова выдаётся
+    EXPECT_FALSE(state.check(3, "a", pending, pending_level));
+    EXPECT_EQ(pending, 0u);
+}
+
+TEST(Policies, CollapsedRepeatsReportCallSite) {
+    auto sink = std::make_shared<CaptureLogger>();
+    GLogger::add(sink);
+    GLogger::set_collapse_repeats(true, std::chrono::milliseconds(20));
+
+    int line = 0;
+    for (int i = 0; i < 5; ++i) {
+        line = __LINE__ + 1;
+        GLOG_INFO("same");
+    }
+
+    // Отчёт приходит по таймеру, без следующего сообщения с этого места
+    const std::string report = "last message repeated 4 times at " + std::string(__FILE__)
+        + ":" + std::to_string(line);
+    std::vector<std::string> lines;
+    for (int i = 0; i < 200 && lines.size() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        for (auto& l : sink->take()) lines.push_back(std::move(l));
+    }
+
+    GLogger::set_collapse_repeats(false);
+    GLogger::remove(sink.get());
+
+    ASSERT_EQ(lines.size(), 2u);
+    EXPECT_EQ(lines[0], "same");
+    EXPECT_EQ(lines[1], report);
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "../iface.h"
+#include "../rcu.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Считает свои экземпляры
+struct Tracked {
+    static inline std::atomic<int> alive{0};
+    int value = 0;
+
+    Tracked() { ++alive; }
+    Tracked(const Tracked& other) : value(other.value) { ++alive; }
+    ~Tracked() { --alive; }
+};
+
+TEST(Rcu, UpdateWaitsForReaderAndFreesOldSnapshot) {
+    {
+        rcu::RcuPtr<Tracked> ptr;
+        std::atomic<bool> holding{false};
+        std::atomic<bool> release{false};
+
+        std::thread reader([&] {
+            auto snapshot = ptr.read();
+            holding = true;
+            while (!release) std::this_thread::yield();
+            EXPECT_EQ(snapshot->value, 0);
+        });
+        while (!holding) std::this_thread::yield();
+
+        std::atomic<bool> updated{false};
+        std::thread writer([&] {
+            ptr.update([](Tracked& t) { t.value = 1; });
+            updated = true;
+        });
+
+        // Пока читатель держит старый снимок, запись не возвращается
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        EXPECT_FALSE(updated);
+        EXPECT_EQ(Tracked::alive, 2);
+
+        release = true;
+        reader.join();
+        writer.join();
+        // Старый снимок удалён до возврата update()
+        EXPECT_EQ(Tracked::alive, 1);
+        EXPECT_EQ(ptr.read()->value, 1);
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(Rcu, UpdateFromReaderDoesNotWaitForItself) {
+    rcu::RcuPtr<Tracked> ptr;
+    {
+        auto snapshot = ptr.read();
+        ptr.update([](Tracked& t) { t.value = 1; });
+        EXPECT_EQ(snapshot->value, 0);
+    }
+    // Отложенный снимок удаляется следующей записью
+    ptr.update([](Tracked& t) { t.value = 2; });
+    EXPECT_EQ(Tracked::alive, 1);
+}
+
+// Медленный синк: log() держит снимок GLogger
+class SlowLogger : public ILogger {
+public:
+    std::atomic<bool> inside{false};
+    std::atomic<bool> release{false};
+
+    void log(LogLevel, const std::string&) override {
+        this->inside = true;
+        while (!this->release) std::this_thread::yield();
+    }
+};
+
+class NullLogger : public ILogger {
+public:
+    void log(LogLevel, const std::string&) override {}
+};
+
+TEST(Rcu, RemovedSinkIsDestroyedWhenRemoveReturns) {
+    auto slow = std::make_shared<SlowLogger>();
+    auto sink = std::make_shared<NullLogger>();
+    std::weak_ptr<NullLogger> weak = sink;
+    GLogger::add(slow);
+    GLogger::add(sink);
+
+    std::thread writer([] { GLogger::log(LogLevel::INFO, "hello"); });
+    while (!slow->inside) std::this_thread::yield();
+
+    std::atomic<bool> removed{false};
+    const ILogger* target = sink.get();
+    std::thread remover([&] {
+        EXPECT_TRUE(GLogger::remove(target));
+        removed = true;
+    });
+    sink.reset();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(removed);
+
+    slow->release = true;
+    writer.join();
+    remover.join();
+    EXPECT_TRUE(weak.expired());
+
+    GLogger::remove(slow.get());
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "../syslog_logger.h"
+#include "../async_logger.h"
+
+#include <memory>
+#include <string>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Локальный unix-сокет вместо journald
+class SyslogListener {
+    int fd = -1;
+
+public:
+    std::string path;
+
+    SyslogListener() {
+        this->path = "/tmp/test_syslog_" + std::to_string(::getpid()) + ".sock";
+        ::unlink(this->path.c_str());
+
+        this->fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, this->path.c_str(), sizeof(addr.sun_path) - 1);
+        ::bind(this->fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+
+        timeval tv{1, 0};
+        ::setsockopt(this->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+
+    ~SyslogListener() {
+        ::close(this->fd);
+        ::unlink(this->path.c_str());
+    }
+
+    // Пустая строка - датаграммы нет
+    std::string receive() {
+        char buf[4096];
+        ssize_t n = ::recv(this->fd, buf, sizeof(buf), 0);
+        return n > 0 ? std::string(buf, n) : std::string();
+    }
+};
+
+class UnixSyslogLoggerTest : public ::testing::Test {
+protected:
+    SyslogListener listener;
+
+    UnixSyslogLogger::Options options(UnixSyslogLogger::Format format = UnixSyslogLogger::Format::RFC3164) {
+        UnixSyslogLogger::Options opts;
+        opts.path = this->listener.path;
+        opts.ident = "TestApp";
+        opts.format = format;
+        return opts;
+    }
+};
+
+// RFC 3164: <PRI>Mmm dd hh:mm:ss ident[pid]: message
+TEST_F(UnixSyslogLoggerTest, Rfc3164Datagram) {
+    UnixSyslogLogger logger(options());
+    logger.error("disk is on fire");
+
+    std::string msg = listener.receive();
+    std::string tail = "TestApp[" + std::to_string(::getpid()) + "]: disk is on fire";
+
+    EXPECT_EQ(msg.rfind("<11>", 0), 0u);  // LOG_USER | LOG_ERR
+    ASSERT_GE(msg.size(), tail.size());
+    EXPECT_EQ(msg.substr(msg.size() - tail.size()), tail);
+    EXPECT_EQ(logger.dropped(), 0u);
+}
+
+// RFC 5424: <PRI>1 TIMESTAMP HOST APP PID - - message
+TEST_F(UnixSyslogLoggerTest, Rfc5424Datagram) {
+    UnixSyslogLogger logger(options(UnixSyslogLogger::Format::RFC5424));
+    logger.debug("hello");
+
+    std::string msg = listener.receive();
+    std::string tail = " TestApp " + std::to_string(::getpid()) + " - - hello";
+
+    EXPECT_EQ(msg.rfind("<15>1 ", 0), 0u);  // LOG_USER | LOG_DEBUG
+    EXPECT_NE(msg.find('T'), std::string::npos);
+    ASSERT_GE(msg.size(), tail.size());
+    EXPECT_EQ(msg.substr(msg.size() - tail.size()), tail);
+}
+
+// Пачка уходит отдельными датаграммами в исходном порядке.
+// Пачка меньше net.unix.max_dgram_qlen (по умолчанию 10), иначе лишнее отбросится.
+TEST_F(UnixSyslogLoggerTest, BatchKeepsOrder) {
+    UnixSyslogLogger logger(options());
+
+    std::vector<LogRecord> records;
+    for (int i = 0; i < 8; ++i) {
+        records.push_back({LogLevel::INFO, std::chrono::system_clock::now(), "msg " + std::to_string(i)});
+    }
+    logger.log_batch(records.data(), records.size());
+    EXPECT_EQ(logger.dropped(), 0u);
+
+    for (int i = 0; i < 8; ++i) {
+        std::string msg = listener.receive();
+        std::string expected = ": msg " + std::to_string(i);
+        ASSERT_GE(msg.size(), expected.size());
+        EXPECT_EQ(msg.substr(msg.size() - expected.size()), expected);
+    }
+}
+
+TEST_F(UnixSyslogLoggerTest, WorksBehindAsyncLogger) {
+    auto syslog = std::make_shared<UnixSyslogLogger>(options());
+    {
+        AsyncLogger async(syslog);
+        for (int i = 0; i < 8; ++i) async.warning("async " + std::to_string(i));
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        std::string msg = listener.receive();
+        EXPECT_EQ(msg.rfind("<12>", 0), 0u);  // LOG_USER | LOG_WARNING
+        EXPECT_NE(msg.find("async " + std::to_string(i)), std::string::npos);
+    }
+}
+
+// Приёмник не читает: логгер не блокируется, лишнее отбрасывается
+TEST_F(UnixSyslogLoggerTest, FullSocketDropsInsteadOfBlocking) {
+    UnixSyslogLogger logger(options());
+    std::string payload(1024, 'x');
+
+    for (int i = 0; i < 10000; ++i) logger.info(payload);
+
+    EXPECT_GT(logger.dropped(), 0u);
+    EXPECT_FALSE(listener.receive().empty());
+}
+
+TEST(UnixSyslogLoggerNoDaemon, MissingSocketDrops) {
+    UnixSyslogLogger::Options opts;
+    opts.path = "/tmp/test_syslog_missing.sock";
+    ::unlink(opts.path.c_str());
+
+    UnixSyslogLogger logger(opts);
+    logger.info("nobody listens");
+    EXPECT_EQ(logger.dropped(), 1u);
+}
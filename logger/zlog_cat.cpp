@@ -0,0 +1,152 @@
+// Распаковка сжатого лога (compressed_logger.h) обратно в текст.
+//
+// Файл читается потоком, в памяти - только текущий кадр. Кадры проверяются
+// по crc32 и пределу размеров (zlog::MAX_FRAME). Испорченный или недописанный
+// кадр пропускается: чтение продолжается со следующего маркера кадра.
+//
+// Использование: zlog_cat app.zlog [out.log]
+
+#include "compressed_logger.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+// Окно над входным потоком: прочитанные, но ещё не разобранные байты
+class Window {
+    static constexpr size_t CHUNK = 1024 * 1024;
+
+    std::istream& in;
+    std::vector<char> buf;
+    size_t pos = 0;
+    bool eof = false;
+
+public:
+    explicit Window(std::istream& in) : in(in) {}
+
+    // Дочитать, чтобы в окне было не меньше n байт; false - файл кончился раньше
+    bool fill(size_t n) {
+        while (this->buf.size() - this->pos < n && !this->eof) {
+            // Разобранное выбрасываем, окно растёт только до размера кадра
+            this->buf.erase(this->buf.begin(), this->buf.begin() + static_cast<std::ptrdiff_t>(this->pos));
+            this->pos = 0;
+
+            const size_t old = this->buf.size();
+            const size_t want = std::max(n - old, CHUNK);
+            this->buf.resize(old + want);
+            this->in.read(this->buf.data() + old, static_cast<std::streamsize>(want));
+            const size_t got = static_cast<size_t>(this->in.gcount());
+            this->buf.resize(old + got);
+            if (got < want) this->eof = true;
+        }
+        return this->buf.size() - this->pos >= n;
+    }
+
+    size_t size() const { return this->buf.size() - this->pos; }
+    const char* data() const { return this->buf.data() + this->pos; }
+    void skip(size_t n) { this->pos += n; }
+};
+
+// Встать на следующий маркер кадра; false - маркеров больше нет
+static bool find_frame(Window& w) {
+    while (w.fill(sizeof(zlog::FrameHeader))) {
+        const size_t last = w.size() - sizeof(zlog::FrameHeader);
+        for (size_t i = 0; i <= last; ++i) {
+            uint32_t magic;
+            std::memcpy(&magic, w.data() + i, sizeof(magic));
+            if (magic == zlog::FRAME_MAGIC) {
+                w.skip(i);
+                return true;
+            }
+        }
+        w.skip(last + 1);
+    }
+    return false;
+}
+
+static int decode(std::istream& in, std::ostream& out) {
+    Window w(in);
+    const size_t header = sizeof(zlog::MAGIC) + sizeof(zlog::VERSION);
+    uint32_t version = 0;
+    if (!w.fill(header) || std::memcmp(w.data(), zlog::MAGIC, sizeof(zlog::MAGIC)) != 0) {
+        std::cerr << "Not a zlog file" << std::endl;
+        return 1;
+    }
+    std::memcpy(&version, w.data() + sizeof(zlog::MAGIC), sizeof(version));
+    if (version != zlog::VERSION) {
+        std::cerr << "Unsupported zlog version " << version << std::endl;
+        return 1;
+    }
+    w.skip(header);
+
+    const size_t max_packed = compressBound(static_cast<uLong>(zlog::MAX_FRAME));
+    std::vector<unsigned char> raw;
+    size_t frames = 0;
+    size_t skipped = 0;
+
+    while (find_frame(w)) {
+        zlog::FrameHeader h;
+        std::memcpy(&h, w.data(), sizeof(h));
+
+        // Размеры crc не покрывает: проверяем их до выделения памяти и чтения
+        bool ok = h.raw_size <= zlog::MAX_FRAME && h.packed_size <= max_packed
+            && w.fill(sizeof(h) + h.packed_size);
+        const unsigned char* packed = reinterpret_cast<const unsigned char*>(w.data()) + sizeof(h);
+        if (ok) {
+            ok = crc32(0L, packed, h.packed_size) == h.crc;
+        }
+        if (ok) {
+            raw.resize(h.raw_size);
+            uLongf raw_size = h.raw_size;
+            ok = uncompress(raw.data(), &raw_size, packed, h.packed_size) == Z_OK
+                && raw_size == h.raw_size;
+        }
+
+        if (!ok) {
+            // Ищем следующий маркер сразу за этим
+            ++skipped;
+            w.skip(1);
+            continue;
+        }
+
+        out.write(reinterpret_cast<const char*>(raw.data()), static_cast<std::streamsize>(raw.size()));
+        ++frames;
+        w.skip(sizeof(h) + h.packed_size);
+    }
+
+    if (skipped) {
+        std::cerr << "Skipped " << skipped << " corrupted or truncated frame(s), "
+                  << frames << " frame(s) decoded" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <file.zlog> [out.log]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    if (argc > 2) {
+        std::ofstream out(argv[2], std::ios::binary);
+        if (!out.is_open()) {
+            std::cerr << "Cannot open " << argv[2] << std::endl;
+            return 1;
+        }
+        return decode(in, out);
+    }
+    return decode(in, std::cout);
+}